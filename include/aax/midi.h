@@ -104,6 +104,7 @@ extern "C" {
 #define MIDI_LYRICS						0x05
 #define MIDI_MARKER						0x06
 #define MIDI_CUE_POINT						0x07
+#define MIDI_PROGRAM_NAME					0x08
 #define MIDI_DEVICE_NAME					0x09
 #define MIDI_CHANNEL_PREFIX					0x20	// 32
 #define MIDI_PORT_PREFERENCE					0x21	// 33
@@ -265,6 +266,73 @@ extern "C" {
 struct aaxMIDI;
 typedef struct aaxMIDI aaxMIDI;
 
+/* statistics */
+#define MIDI_STATS_MAX_CHANNELS					32
+#define MIDI_LIVE_LATENCY_BUCKETS				24
+
+enum aaxMIDIEventType
+{
+    AAX_MIDI_NOTE_OFF_EVENT = 0,
+    AAX_MIDI_NOTE_ON_EVENT,
+    AAX_MIDI_POLYPHONIC_AFTERTOUCH_EVENT,
+    AAX_MIDI_CONTROL_CHANGE_EVENT,
+    AAX_MIDI_PROGRAM_CHANGE_EVENT,
+    AAX_MIDI_CHANNEL_AFTERTOUCH_EVENT,
+    AAX_MIDI_PITCH_BEND_EVENT,
+    AAX_MIDI_SYSTEM_EXCLUSIVE_EVENT,
+    AAX_MIDI_META_EVENT,
+    AAX_MIDI_SYSTEM_EVENT,
+
+    AAX_MIDI_EVENT_MAX
+};
+
+typedef struct
+{
+    /* events dispatched by type, see enum aaxMIDIEventType */
+    uint64_t events[AAX_MIDI_EVENT_MAX];
+
+    /* time spent in aaxMIDIProcess */
+    uint64_t process_calls;
+    uint64_t process_time_us;
+    uint32_t process_time_max_us;
+
+    /* instrument resolution */
+    uint64_t cache_hits;
+    uint64_t cache_misses;
+
+    /* instrument and drum patches loaded from disk */
+    uint32_t patch_loads;
+    uint64_t patch_load_time_us;
+    uint32_t patch_load_time_max_us;
+
+    /* audio graph */
+    uint32_t ensembles;
+    uint32_t mixers;
+
+    /* number of parts sending to the effects buses */
+    uint32_t chorus_parts;
+    uint32_t delay_parts;
+    uint32_t reverb_parts;
+
+    /*
+     * per channel: the keys which are down, the voices which sound,
+     * including the ones in their release stage, and the most voices
+     * at once. retriggered counts note-ons for a key which was down.
+     */
+    struct {
+        uint32_t keys;
+        uint32_t active;
+        uint32_t peak;
+        uint32_t retriggered;
+    } voices[MIDI_STATS_MAX_CHANNELS];
+} aaxMIDIStats;
+
+enum aaxMIDIExportFormat
+{
+    AAX_MIDI_EXPORT_CSV = 0,
+    AAX_MIDI_EXPORT_NDJSON
+};
+
 aaxMIDI* aaxMIDICreate(const char *devname, const char *filename, const char *track, enum aaxRenderMode mode, const char *config);
 void aaxMIDIDesrtroy(aaxMIDI*);
 
@@ -295,6 +363,51 @@ void aaxMIDISetMono(aaxMIDI*, int m);
 void aaxMIDISetVerbose(aaxMIDI*, char v);
 void aaxMIDISetCSV(aaxMIDI*, char v);
 
+/* thread safe playback control, applied at the next aaxMIDIProcess call */
+int aaxMIDIPause(aaxMIDI*);
+int aaxMIDIResume(aaxMIDI*);
+int aaxMIDISeek(aaxMIDI*, float pos_sec);
+int aaxMIDISetVolume(aaxMIDI*, float g);
+int aaxMIDISetTrackMute(aaxMIDI*, int track, int mute);
+int aaxMIDISetTrackSolo(aaxMIDI*, int track);
+int aaxMIDISetTempoScale(aaxMIDI*, float s);
+
+/* may be called from any thread */
+int aaxMIDIGetStats(aaxMIDI*, aaxMIDIStats*);
+
+/* writes all events of a MIDI file to outfile, or stdout if it is NULL,
+ * no device is needed */
+int aaxMIDIExport(const char *filename, const char *outfile, enum aaxMIDIExportFormat format);
+
+/* writes a Chrome trace (JSON) of the playback which can be loaded in
+ * chrome://tracing or https://ui.perfetto.dev, until it gets closed */
+int aaxMIDITraceOpen(const char *filename);
+void aaxMIDITraceClose(void);
+
+/* live input: plays raw MIDI bytes as they arrive from stdin ("-"),
+ * a FIFO, "udp:[host:]port" or "unix:path" */
+struct aaxMIDIInput;
+typedef struct aaxMIDIInput aaxMIDIInput;
+
+aaxMIDIInput* aaxMIDIInputCreate(const char *devname, const char *input, const char *track, enum aaxRenderMode mode, const char *config);
+void aaxMIDIInputDestroy(aaxMIDIInput*);
+
+void aaxMIDIInputInitialize(aaxMIDIInput*);
+void aaxMIDIInputStart(aaxMIDIInput*);
+void aaxMIDIInputStop(aaxMIDIInput*);
+int aaxMIDIInputProcess(aaxMIDIInput*, uint64_t time_parts, uint32_t* next);
+int32_t aaxMIDIInputGetUSPP(aaxMIDIInput*);
+
+void aaxMIDIInputSetVolume(aaxMIDIInput*, float g);
+void aaxMIDIInputSetMono(aaxMIDIInput*, int m);
+void aaxMIDIInputSetVerbose(aaxMIDIInput*, char v);
+
+/* may be called from any thread, bucket n of the latency histogram counts
+ * the messages with an arrival to dispatch latency between 2^n and
+ * 2^(n+1) microseconds */
+int aaxMIDIInputGetStats(aaxMIDIInput*, aaxMIDIStats*);
+int aaxMIDIInputGetLatency(aaxMIDIInput*, uint32_t buckets[MIDI_LIVE_LATENCY_BUCKETS]);
+
 
 #if defined(__cplusplus)
 }	/* extern "C" */
@@ -302,6 +415,7 @@ void aaxMIDISetCSV(aaxMIDI*, char v);
 #include <memory>
 #include <sstream>
 #include <functional>
+#include <chrono>
 
 #include <aax/aeonwave>
 #include <aax/instrument>
@@ -358,10 +472,69 @@ public:
     void set_verbose(char v);
     void set_csv(char v);
 
+    // the look-ahead parser window in seconds, zero disables the parser
+    void set_lookahead(float sec);
+    void set_timeline(bool t);
+
+    // thread safe playback control, applied at the next call to process()
+    bool post_pause();
+    bool post_resume();
+    bool post_seek(float pos_sec);
+    bool post_volume(float g);
+    bool post_track_mute(uint16_t track, bool mute);
+    bool post_track_solo(int32_t track);
+    bool post_tempo_scale(float s);
+
+    // may be called from any thread
+    bool get_stats(aaxMIDIStats& s);
+
 private:
     std::unique_ptr<MIDIFile> file;
 };
 
+class MIDILive;
+class MIDIInput
+{
+public:
+    MIDIInput(const char *devname, const char *input, const char *track=nullptr, enum aaxRenderMode mode=AAX_MODE_WRITE_STEREO, const char *config=nullptr);
+
+    virtual ~MIDIInput();
+
+    void initialize();
+    void start();
+    void stop();
+
+    // dispatch all pending messages, next is the poll interval in parts
+    bool process(uint64_t time_parts, uint32_t& next);
+    int32_t get_uspp();
+
+    void set_volume(float g = 1.0f);
+    void set_mono(bool m);
+    void set_verbose(char v);
+
+    // may be called from any thread
+    bool get_stats(aaxMIDIStats& s);
+    bool get_latency(uint32_t buckets[MIDI_LIVE_LATENCY_BUCKETS]);
+    void print_latency_histogram();
+
+private:
+    std::unique_ptr<MIDILive> live;
+};
+
+// Records the time spent in the current scope as a sleep of the scheduler
+// between two calls to process(), when the trace is open.
+class MIDITraceSleep
+{
+public:
+    explicit MIDITraceSleep(float requested_sec);
+    ~MIDITraceSleep();
+
+private:
+    std::chrono::steady_clock::time_point start;
+    int64_t requested_us = 0;
+    bool enabled = false;
+};
+
 namespace midi
 {
 
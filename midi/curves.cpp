@@ -0,0 +1,74 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave MIDI library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#include <cmath>
+
+#include <aax/instrument>
+
+#include <midi/curves.hpp>
+
+using namespace aeonwave;
+
+void
+MIDIExp2Curve::build(float scale)
+{
+    k = scale;
+    for (int i=0; i<MIDI_CURVE_SIZE; ++i) {
+        v[i] = exp2f(i*scale);
+    }
+}
+
+// A negative bend is scaled by 8192 and a positive bend by 8191 so that
+// both ends of the range reach the full bend range.
+void
+MIDIPitchBendCurve::build(float semitones)
+{
+    float k[2] = { semitones/(12.0f*8192.0f), semitones/(12.0f*8191.0f) };
+
+    range = semitones;
+    for (int i=0; i<MIDI_CURVE_SIZE; ++i)
+    {
+        bool positive = (i >= 0x40);
+        coarse[i] = exp2f(float((i << 7) - 8192)*k[positive]);
+        fine[0][i] = exp2f(i*k[0]);
+        fine[1][i] = exp2f(i*k[1]);
+    }
+}
+
+float
+MIDICurves::gain(uint8_t value)
+{
+    static const auto table = [] {
+        std::array<float, MIDI_CURVE_SIZE> rv;
+        for (int i=0; i<MIDI_CURVE_SIZE; ++i) {
+            rv[i] = math::ln(float(i)/127.0f);
+        }
+        return rv;
+    }();
+    return table[value & 0x7f];
+}
+
+// The key frequency ranges from 8 - 12544 Hz,
+// log(20) = 1.3, log(12544) = 4.1
+float
+MIDICurves::pan(uint8_t note_no)
+{
+    static const auto table = [] {
+        std::array<float, MIDI_CURVE_SIZE> rv;
+        for (int i=0; i<MIDI_CURVE_SIZE; ++i)
+        {
+            float freq = math::note2freq(i);
+            float p = (math::lin2log(freq) - 1.3f)/2.8f; // 0.0f .. 1.0f
+            rv[i] = floorf(-2.0f*(p-0.5f)*note::pan_levels)/note::pan_levels;
+        }
+        return rv;
+    }();
+    return table[note_no & 0x7f];
+}
+
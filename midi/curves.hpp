@@ -0,0 +1,90 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave MIDI library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include <array>
+
+namespace aeonwave
+{
+
+#define MIDI_CURVE_SIZE			128
+
+// 2^(value*scale) for a 7-bit controller value, the table is rebuilt
+// when the scale changes.
+class MIDIExp2Curve
+{
+public:
+    MIDIExp2Curve() { v.fill(1.0f); }
+
+    inline float get(uint8_t value, float scale) {
+        if (scale != k) build(scale);
+        return v[value & 0x7f];
+    }
+
+private:
+    void build(float scale);
+
+    std::array<float, MIDI_CURVE_SIZE> v;
+    float k = 0.0f;
+};
+
+// The pitch of a 14-bit pitch bend value for a bend range in semitones.
+// The exponent is linear in the bend value so the pitch is the product
+// of a coarse table for the upper seven bits and a fine table for the
+// lower seven bits, the fine table depends on the sign of the bend.
+class MIDIPitchBendCurve
+{
+public:
+    MIDIPitchBendCurve() {
+        coarse.fill(1.0f);
+        for (auto& it : fine) it.fill(1.0f);
+    }
+
+    inline float get(uint16_t pitch, float semitones)
+    {
+        if (semitones != range) build(semitones);
+
+        uint8_t msb = (pitch >> 7) & 0x7f;
+        return coarse[msb]*fine[msb >= 0x40][pitch & 0x7f];
+    }
+
+private:
+    void build(float semitones);
+
+    std::array<float, MIDI_CURVE_SIZE> coarse;
+    std::array<std::array<float, MIDI_CURVE_SIZE>, 2> fine;
+    float range = 0.0f;
+};
+
+/*
+ * The conversion tables of the controllers of one MIDI channel.
+ *
+ * The tables which depend on a channel setting, like the pitch bend
+ * range, rebuild themselves when it changes which keeps them correct
+ * no matter how the setting was changed.
+ */
+struct MIDICurves
+{
+    MIDIPitchBendCurve pitch_bend;
+    MIDIExp2Curve pressure;
+    MIDIExp2Curve modulation;
+    MIDIExp2Curve celeste;
+
+    // the channel volume and expression curve
+    static float gain(uint8_t value);
+
+    // the wide stereo position of a key
+    static float pan(uint8_t note_no);
+};
+
+} // namespace aeonwave
+
@@ -22,6 +22,7 @@
 #include <midi/ensemble.hpp>
 
 using namespace aax;
+using policy_t = MIDIPolicyRuntime;
 
 MIDIDriver::MIDIDriver(const char* n, const char *selections, enum aaxRenderMode m)
         : AeonWave(n, m)
@@ -35,6 +36,11 @@ MIDIDriver::MIDIDriver(const char* n, const char *selections, enum aaxRenderMode
     else refrate = 45.0f;
     midi.set(AAX_REFRESH_RATE, refrate);
 
+    char *trace = getenv("AAX_MIDI_TRACE");
+    if (trace && !MIDITrace::enabled()) {
+        MIDITrace::instance().open(trace);
+    }
+
     if (*this) {
         set_path();
     }
@@ -148,7 +154,8 @@ void
 MIDIDriver::rewind()
 {
     channels.clear();
-    uSPP = tempo/PPQN;
+    parked_channels.clear();
+    uSPP = tempo/(PPQN*tempo_scale);
 
     chorus_channels.clear();
 
@@ -165,6 +172,55 @@ MIDIDriver::rewind()
         AeonWave::add(*it.second);
     }
     reverb_channels.clear();
+
+    GS_image.clear();
+    XG_image.clear();
+    for (auto& it : params) it.reset();
+    song_arena.release();
+
+    statistics.rewind();
+    update_stats();
+}
+
+// The voices only stop sounding when their release stage ends, so the
+// number of voices of every channel gets sampled every now and then.
+void
+MIDIDriver::update_voices()
+{
+    auto now = MIDIStats::clock::now();
+    if (initialize ||
+        now - voices_time < std::chrono::milliseconds(MIDI_STATS_VOICES_MSEC)) {
+        return;
+    }
+    voices_time = now;
+
+    for (const auto& it : channels) {
+        statistics.voices(it.first, it.second->active_voices());
+    }
+}
+
+// Take a snapshot of the audio graph, called whenever it changes.
+void
+MIDIDriver::update_stats()
+{
+    uint32_t mixers = 3; // the chorus, delay and reverb buses
+    uint32_t chorus_parts = 0;
+    uint32_t delay_parts = 0;
+    uint32_t reverb_parts = 0;
+
+    for (const auto& it : channels)
+    {
+        MIDIEnsemble& part = *it.second;
+        mixers++;
+        if (part.get_chorus_level() > 0.0f) chorus_parts++;
+        if (part.get_delay_level() > 0.0f) delay_parts++;
+        if (part.get_reverb_level() > 0.0f) reverb_parts++;
+    }
+    for (const auto& it : parked_channels) {
+        mixers += it.second.size();
+    }
+    statistics.graph(channels.size(), mixers,
+                     chorus_parts, delay_parts, reverb_parts);
 }
 
 void MIDIDriver::finish(uint8_t n)
@@ -252,6 +308,8 @@ MIDIDriver::set_gm2_chorus_type(uint16_t type)
 bool
 MIDIDriver::set_chorus(const char* t, uint16_t type, uint8_t vendor)
 {
+    trace_scope trace("set_chorus", "effects", -1, t, !initialize);
+
     if (type != -1)
     {
         uint32_t vendor_type = uint32_t(vendor) << 16 | type;
@@ -291,6 +349,7 @@ void
 MIDIDriver::set_chorus_level(uint16_t part_no, float val)
 {
     auto& part = midi.channel(part_no);
+    bool changed = ((val > 0.0f) != (part.get_chorus_level() > 0.0f));
 #if 0
     if (val > 0.0f)
     {
@@ -330,6 +389,7 @@ MIDIDriver::set_chorus_level(uint16_t part_no, float val)
     aax::Buffer& disabled = AeonWave::buffer("GM2/chorus0");
     part.set_chorus(val > 0.0f ? *chorus_buffer : disabled);
     part.set_chorus_level(val);
+    if (changed) update_stats();
 }
 
 void
@@ -391,6 +451,8 @@ MIDIDriver::set_chorus_cutoff_frequency(float val)
 bool
 MIDIDriver::set_delay(const char* t, uint16_t type, uint8_t vendor)
 {
+    trace_scope trace("set_delay", "effects", -1, t, !initialize);
+
     if (type != -1)
     {
         uint32_t vendor_type = uint32_t(vendor) << 16 | type;
@@ -430,6 +492,7 @@ void
 MIDIDriver::set_delay_level(uint16_t part_no, float val)
 {
     auto& part = midi.channel(part_no);
+    bool changed = ((val > 0.0f) != (part.get_delay_level() > 0.0f));
 #if 0
     if (val > 0.0f)
     {
@@ -468,6 +531,7 @@ MIDIDriver::set_delay_level(uint16_t part_no, float val)
     aax::Buffer& disabled = AeonWave::buffer("GM2/delay0");
     part.set_delay(val > 0.0f ? *delay_buffer : disabled);
     part.set_delay_level(val);
+    if (changed) update_stats();
 }
 
 void
@@ -515,6 +579,8 @@ MIDIDriver::set_delay_cutoff_frequency(float fc)
 bool
 MIDIDriver::set_reverb(const char* t, uint16_t type, uint8_t vendor)
 {
+    trace_scope trace("set_reverb", "effects", -1, t, !initialize);
+
     if (type != -1)
     {
         uint32_t vendor_type = uint32_t(vendor) << 16 | type;
@@ -577,6 +643,7 @@ void
 MIDIDriver::set_reverb_level(uint16_t part_no, float val)
 {
     auto& part = midi.channel(part_no);
+    bool changed = ((val > 0.0f) != (part.get_reverb_level() > 0.0f));
     if (val > 0.0f)
     {
         if (1 || part.get_reverb_level() == 0.0f)
@@ -610,6 +677,7 @@ MIDIDriver::set_reverb_level(uint16_t part_no, float val)
         }
     }
     part.set_reverb_level(val);
+    if (changed) update_stats();
 }
 
 void
@@ -636,13 +704,12 @@ MIDIDriver::set_reverb_delay_depth(float val) {
 /*
  * Create map of instrument banks and program numbers with their associated
  * file names from the XML files for a quick access during playback.
+ * The XML files are only parsed if their cached index is out of date.
  */
 void
 MIDIDriver::read_instruments(std::string gmmidi, std::string gmdrums)
 {
     std::string type = "instrument";
-    std::string filename;
-    auto imap = instrument_map;
 
     std::filesystem::path iname;
     if (!gmmidi.empty())
@@ -658,272 +725,361 @@ MIDIDriver::read_instruments(std::string gmmidi, std::string gmdrums)
         iname.append(instr);
     }
 
-    filename = iname.c_str();
     for(unsigned int id=0; id<2; ++id)
     {
-        xmlId *xid = xmlOpen(filename.c_str());
-        if (xid)
+        auto index = std::make_unique<MIDIIndex>(iname, type);
+        if (!index->load() && read_index(*index, iname.string(), type)) {
+            index->save();
+        }
+
+        if (id == 0)
         {
-            xmlId *xaid = xmlNodeGet(xid, "aeonwave");
-            xmlId *xmid = nullptr;
-            char note_off[64] = "";
-            char note_on[64] = "";
-            char name[64] = "";
-            char file[64] = "";
+            add_index(index, instrument_map, instrument_index);
 
-            if (xaid)
+            // next up: drums
+            if (!gmdrums.empty())
             {
-                if (xmlAttributeExists(xaid, "rate"))
-                {
-                    unsigned int rate = xmlAttributeGetInt(xaid, "rate");
-                    if (rate >= 25 && rate <= 200) {
-                       refresh_rate = rate;
-                    }
-                }
-                if (xmlAttributeExists(xaid, "polyphony"))
+                iname = gmdrums;
+                if (!midi.exists(iname))
                 {
-                    polyphony =  xmlAttributeGetInt(xaid, "polyphony");
-                    if (polyphony < 32) polyphony = 32;
-                    if (polyphony < INT_MAX) {
-                        midi.set(AAX_MONO_EMITTERS, midi.get_polyphony());
-                    }
+                   iname = path;
+                   iname.append(gmmidi);
                 }
-                xmid = xmlNodeGet(xaid, "set"); // was: midi
-            }
-            else {
-                ERROR("aeonwave not found in: " << filename);
+            } else {
+                iname = path;
+                iname.append(drum);
             }
+            type = "patch";
+        }
+        else {
+            add_index(index, drum_map, drum_index);
+        }
+    }
+
+    if (!midi.get_initialize() && drum_set_no != -1)
+    {
+        std::ostringstream s;
+
+        auto it = configuration_map.find(drum_set_no<<7);
+        if (it != configuration_map.end()) {
+            s << "Switching to drum " << it->second[0].name;
+        } else {
+            s << "Switching to drum set number:  " << drum_set_no+1;
+        }
+        INFO(s.str().c_str());
+    }
+}
 
-            if (xmid)
+/*
+ * Apply the settings of an index and add its banks to map. The programs
+ * are added to the bank by find_program() when they are requested.
+ * Indices which were added before take precedence.
+ */
+void
+MIDIDriver::add_index(std::unique_ptr<MIDIIndex>& index, bank_map_t& map,
+                      index_list_t& list)
+{
+    if (index->refresh_rate >= 25 && index->refresh_rate <= 200) {
+        refresh_rate = index->refresh_rate;
+    }
+    if (index->polyphony)
+    {
+        polyphony = index->polyphony;
+        if (polyphony < INT_MAX) {
+            midi.set(AAX_MONO_EMITTERS, midi.get_polyphony());
+        }
+    }
+    if (patch_set == "default" && !index->patch_set.empty()) {
+        patch_set = index->patch_set;
+    }
+    if (index->instrument_mode != -1) {
+        instrument_mode = aaxCapabilities(index->instrument_mode);
+    }
+    if (!index->patch_version.empty()) {
+        patch_version = index->patch_version;
+    }
+    if (index->has_effects) {
+        effects = index->effects;
+    }
+    if (index->drum_set_no != -1) {
+        drum_set_no = index->drum_set_no;
+    }
+
+    for (auto& it : index->configurations) {
+        configuration_map.insert(std::move(it));
+    }
+
+    for (uint16_t bank_no : index->get_banks()) {
+        map[bank_no];
+    }
+    list.push_back(std::move(index));
+}
+
+/*
+ * Find a program in a bank of the instrument or drum map. If it was not
+ * requested before it gets read from the indices.
+ */
+MIDIDriver::program_map_t::iterator
+MIDIDriver::find_program(bank_map_t::iterator itb, index_list_t& list,
+                         int program_no)
+{
+    auto& bank = itb->second;
+    auto rv = bank.find(program_no);
+    if (rv == bank.end())
+    {
+        for (auto& index : list)
+        {
+            ensemble_map_t patches;
+            bool include;
+            if (index->get(itb->first, program_no, patches, include))
             {
-                if (patch_set == "default" && xmlAttributeExists(xmid, "name"))
+                if (include)
                 {
-                    char *set = xmlAttributeGetString(xmid, "name");
-                    if (set && strlen(set) != 0) {
-                        patch_set = set;
-                    }
-                    xmlFree(set);
+                    std::string name = patches[0].name;
+                    std::string file = patches[0].file;
+                    patches.clear();
+                    read_ensemble(patches, name.c_str(), file.c_str());
                 }
-
-                if (xmlAttributeExists(xmid, "mode"))
+                if (patches.size() > 0)
                 {
-                   if (!xmlAttributeCompareString(xmid, "mode", "synthesizer"))
-                   {
-                       instrument_mode = AAX_RENDER_SYNTHESIZER;
-                   }
-                   else if (!xmlAttributeCompareString(xmid, "mode", "arcade"))
-                   {
-                       instrument_mode = AAX_RENDER_ARCADE;
-                   }
+                    rv = bank.insert({program_no, std::move(patches)}).first;
+                    break;
                 }
+            }
+        }
+    }
+    return rv;
+}
 
-                if (xmlAttributeExists(xmid, "version"))
-                {
-                    char *set = xmlAttributeGetString(xmid, "version");
-                    if (set && strlen(set) != 0) {
-                        patch_version = set;
-                    }
-                    xmlFree(set);
+// Parse the XML file into index, returns false if it could not be read.
+bool
+MIDIDriver::read_index(MIDIIndex& index, const std::string& filename,
+                       const std::string& type)
+{
+    bool rv = false;
+    xmlId *xid = xmlOpen(filename.c_str());
+    if (xid)
+    {
+        xmlId *xaid = xmlNodeGet(xid, "aeonwave");
+        xmlId *xmid = nullptr;
+        char note_off[64] = "";
+        char note_on[64] = "";
+        char name[64] = "";
+        char file[64] = "";
+
+        if (xaid)
+        {
+            if (xmlAttributeExists(xaid, "rate")) {
+                index.refresh_rate = xmlAttributeGetInt(xaid, "rate");
+            }
+            if (xmlAttributeExists(xaid, "polyphony"))
+            {
+                index.polyphony = xmlAttributeGetInt(xaid, "polyphony");
+                if (index.polyphony < 32) index.polyphony = 32;
+            }
+            xmid = xmlNodeGet(xaid, "set"); // was: midi
+        }
+        else {
+            ERROR("aeonwave not found in: " << filename);
+        }
+
+        if (xmid)
+        {
+            if (xmlAttributeExists(xmid, "name"))
+            {
+                char *set = xmlAttributeGetString(xmid, "name");
+                if (set && strlen(set) != 0) {
+                    index.patch_set = set;
                 }
+                xmlFree(set);
+            }
+
+            if (xmlAttributeExists(xmid, "mode"))
+            {
+               if (!xmlAttributeCompareString(xmid, "mode", "synthesizer"))
+               {
+                   index.instrument_mode = AAX_RENDER_SYNTHESIZER;
+               }
+               else if (!xmlAttributeCompareString(xmid, "mode", "arcade"))
+               {
+                   index.instrument_mode = AAX_RENDER_ARCADE;
+               }
+            }
 
-                if (xmlAttributeExists(xmid, "file")) {
-                    effects = xmlAttributeGetString(xmid, "file");
+            if (xmlAttributeExists(xmid, "version"))
+            {
+                char *set = xmlAttributeGetString(xmid, "version");
+                if (set && strlen(set) != 0) {
+                    index.patch_version = set;
                 }
+                xmlFree(set);
+            }
 
-                unsigned int bnum = xmlNodeGetNum(xmid, "layer"); // bank
-                xmlId *xbid = xmlMarkId(xmid);
-                for (unsigned int b=0; b<bnum; b++)
+            if (xmlAttributeExists(xmid, "file"))
+            {
+                char *set = xmlAttributeGetString(xmid, "file");
+                if (set) index.effects = set;
+                index.has_effects = true;
+                xmlFree(set);
+            }
+
+            unsigned int bnum = xmlNodeGetNum(xmid, "layer"); // bank
+            xmlId *xbid = xmlMarkId(xmid);
+            for (unsigned int b=0; b<bnum; b++)
+            {
+                if (xmlNodeGetPos(xmid, xbid, "layer", b) != 0)
                 {
-                    if (xmlNodeGetPos(xmid, xbid, "layer", b) != 0)
-                    {
-                        xmlId *xiid = xmlMarkId(xbid);
-                        unsigned int slen, inum;
-                        uint16_t bank_no;
-                        char offset;
+                    xmlId *xiid = xmlMarkId(xbid);
+                    unsigned int slen, inum;
+                    uint16_t bank_no;
+                    char offset;
 
-                        bank_no = xmlAttributeGetInt(xbid, "n") << 7;
-                        bank_no += xmlAttributeGetInt(xbid, "l");
+                    bank_no = xmlAttributeGetInt(xbid, "n") << 7;
+                    bank_no += xmlAttributeGetInt(xbid, "l");
 
-                        offset = xmlAttributeGetInt(xbid, "offset");
+                    offset = xmlAttributeGetInt(xbid, "offset");
 
-                        if (bank_no == 0 && xmlAttributeExists(xbid, "default-drums"))
-                        {
-                            drum_set_no = xmlAttributeGetInt(xbid, "default-drums");
-                        }
+                    if (bank_no == 0 && xmlAttributeExists(xbid, "default-drums"))
+                    {
+                        index.drum_set_no = xmlAttributeGetInt(xbid, "default-drums");
+                    }
 
-                        // bank name
-                        xmlAttributeCopyString(xiid, "name", name, 64);
+                    // bank name
+                    xmlAttributeCopyString(xiid, "name", name, 64);
 
-                        // bank audio-frame filter and effects file
-                        slen = xmlAttributeCopyString(xbid, "file", file, 64);
-                        if (slen)
-                        {
-                            file[slen] = 0;
-                            configuration_map.insert({bank_no,{{name,file}}});
-                        }
+                    // bank audio-frame filter and effects file
+                    slen = xmlAttributeCopyString(xbid, "file", file, 64);
+                    if (slen)
+                    {
+                        file[slen] = 0;
+                        index.configurations.insert({bank_no,{{name,file}}});
+                    }
 
-                        // type is 'instrument' or ´patch' for drums/patch
-                        inum = xmlNodeGetNum(xbid, type.c_str());
-                        auto& bank = imap[bank_no];
-                        for (size_t i=0; i<inum; i++)
+                    // type is 'instrument' or ´patch' for drums/patch
+                    inum = xmlNodeGetNum(xbid, type.c_str());
+                    index.add_bank(bank_no);
+                    for (size_t i=0; i<inum; i++)
+                    {
+                        if (xmlNodeGetPos(xbid, xiid, type.c_str(), i) != 0)
                         {
-                            if (xmlNodeGetPos(xbid, xiid, type.c_str(), i) != 0)
-                            {
-                                float gain = 1.0f;
-                                float pitch = 1.0f;
-                                if (xmlAttributeExists(xiid, "gain")) {
-                                    gain = xmlAttributeGetInt(xiid, "gain");
-                                }
-                                if (xmlAttributeExists(xiid, "pitch")) {
-                                    pitch = xmlAttributeGetInt(xiid, "pitch");
-                                }
+                            float gain = 1.0f;
+                            float pitch = 1.0f;
+                            if (xmlAttributeExists(xiid, "gain")) {
+                                gain = xmlAttributeGetInt(xiid, "gain");
+                            }
+                            if (xmlAttributeExists(xiid, "pitch")) {
+                                pitch = xmlAttributeGetInt(xiid, "pitch");
+                            }
 
-                                int count = 1;
-                                if (xmlAttributeExists(xiid, "count")) {
-                                    count = xmlAttributeGetInt(xiid, "count");
-                                }
+                            int count = 1;
+                            if (xmlAttributeExists(xiid, "count")) {
+                                count = xmlAttributeGetInt(xiid, "count");
+                            }
 
-                                int min = 0;
-                                int max = aax::note::max;
-                                if (xmlAttributeExists(xiid, "min")) {
-                                    min = xmlAttributeGetInt(xiid, "min");
-                                }
-                                if (xmlAttributeExists(xiid, "max")) {
-                                    max = xmlAttributeGetInt(xiid, "max");
-                                }
-                                int n = xmlAttributeGetInt(xiid, "n");
-                                if (type == "instrument")
-                                {
-                                    if (!offset) n++;
-                                    else n -= (offset-1);
-                                }
-                                else if (!min && !max) {
-                                    min = max = n;
-                                }
+                            int min = 0;
+                            int max = aax::note::max;
+                            if (xmlAttributeExists(xiid, "min")) {
+                                min = xmlAttributeGetInt(xiid, "min");
+                            }
+                            if (xmlAttributeExists(xiid, "max")) {
+                                max = xmlAttributeGetInt(xiid, "max");
+                            }
+                            int n = xmlAttributeGetInt(xiid, "n");
+                            if (type == "instrument")
+                            {
+                                if (!offset) n++;
+                                else n -= (offset-1);
+                            }
+                            else if (!min && !max) {
+                                min = max = n;
+                            }
 
-                                bool stereo = xmlAttributeGetBool(xiid, "stereo");
+                            bool stereo = xmlAttributeGetBool(xiid, "stereo");
 
-                                int wide = xmlAttributeGetInt(xiid, "wide");
-                                if (!wide && (stereo || xmlAttributeGetBool(xiid, "wide"))) {
-                                    wide = -1;
-                                }
+                            int wide = xmlAttributeGetInt(xiid, "wide");
+                            if (!wide && (stereo || xmlAttributeGetBool(xiid, "wide"))) {
+                                wide = -1;
+                            }
 
-                                float spread = 1.0f;
-                                if (xmlAttributeExists(xiid, "spread")) {
-                                   spread = xmlAttributeGetDouble(xiid, "spread");
-                                }
+                            float spread = 1.0f;
+                            if (xmlAttributeExists(xiid, "spread")) {
+                               spread = xmlAttributeGetDouble(xiid, "spread");
+                            }
+
+                            // drums: keys of the same class cut each other
+                            int exclusive = 0;
+                            if (xmlAttributeExists(xiid, "exclusive")) {
+                                exclusive = xmlAttributeGetInt(xiid, "exclusive");
+                            }
 
-                                // instrument name
-                                xmlAttributeCopyString(xiid, "name",
-                                                              name, 64);
+                            // instrument name
+                            xmlAttributeCopyString(xiid, "name",
+                                                          name, 64);
 
-                                // note-on file-name
-                                note_on[0] = '\0';
-                                xmlAttributeCopyString(xiid, "note-on",
-                                                              note_on, 64);
+                            // note-on file-name
+                            note_on[0] = '\0';
+                            xmlAttributeCopyString(xiid, "note-on",
+                                                          note_on, 64);
 
-                                // note-off file-name
-                                note_off[0] = '\0';
-                                xmlAttributeCopyString(xiid, "note-off",
-                                                              note_off, 64);
+                            // note-off file-name
+                            note_off[0] = '\0';
+                            xmlAttributeCopyString(xiid, "note-off",
+                                                          note_off, 64);
 
-                                // instrument file-name
-                                slen = xmlAttributeCopyString(xiid, "file",
+                            // instrument file-name
+                            slen = xmlAttributeCopyString(xiid, "file",
+                                                          file, 64);
+                            if (slen)
+                            {
+                                file[slen] = 0;
+                                index.add_patch(bank_no, n,
+                                            {name,file,note_on,note_off,
+                                             gain,pitch,1.0f,0.0f,
+                                             spread,wide,count,
+                                             min,max,stereo,false,
+                                             exclusive});
+
+//                              printf("{%x, {%i, {%s, %i}}}\n", bank_no, n, file, wide);
+                            }
+                            else // ensembles?
+                            {
+                                slen = xmlAttributeCopyString(xiid, "include",
                                                               file, 64);
                                 if (slen)
                                 {
                                     file[slen] = 0;
-                                    bank.insert({n,{{name,file,note_on,note_off,
-                                                 gain,pitch,1.0f,0.0f,
-                                                 spread,wide,count,
-                                                 min,max,stereo,false}}});
-
-//                                  if (id == 0) printf("{%x, {%i, {%s, %i}}}\n", bank_no, n, file, wide);
-                                }
-                                else // ensembles?
-                                {
-                                    slen = xmlAttributeCopyString(xiid, "include",
-                                                                  file, 64);
-                                    if (slen)
-                                    {
-                                        file[slen] = 0;
-                                        read_ensemble(bank, name, file, bank_no, n);
-                                    }
+                                    index.add_ensemble(bank_no, n, name, file);
                                 }
                             }
                         }
-
-                        if (bank.size() > 0) {
-                            imap[bank_no] = bank;
-                        }
-                        xmlFree(xiid);
                     }
+                    xmlFree(xiid);
                 }
-                xmlFree(xbid);
-                xmlFree(xmid);
-                xmlFree(xaid);
-            }
-            else {
-                xmlFree(xaid);
-                ERROR("aeonwave/set not found in: " << filename);
             }
-            xmlClose(xid);
+            xmlFree(xbid);
+            xmlFree(xmid);
+            xmlFree(xaid);
+            rv = true;
         }
         else {
-            ERROR("Unable to open: " << filename);
-        }
-
-        if (id == 0)
-        {
-            if (imap.size() > 0) {
-                instrument_map = std::move(imap);
-            }
-
-            // next up: drums
-            if (!gmdrums.empty())
-            {
-                iname = gmdrums;
-                if (!midi.exists(iname))
-                {
-                   iname = path;
-                   iname.append(gmmidi);
-                }
-            } else {
-                iname = path;
-                iname.append(drum);
-            }
-            filename = iname.c_str();
-            type = "patch";
-            imap = drum_map;
-        }
-        else
-        {
-            if (imap.size() > 0)  {
-                drum_map = std::move(imap);
-            }
+            xmlFree(xaid);
+            ERROR("aeonwave/set not found in: " << filename);
         }
+        xmlClose(xid);
     }
-
-    if (!midi.get_initialize() && drum_set_no != -1)
-    {
-        std::ostringstream s;
-
-        auto it = configuration_map.find(drum_set_no<<7);
-        if (it != configuration_map.end()) {
-            s << "Switching to drum " << it->second[0].name;
-        } else {
-            s << "Switching to drum set number:  " << drum_set_no+1;
-        }
-        INFO(s.str().c_str());
+    else {
+        ERROR("Unable to open: " << filename);
     }
+
+    return rv;
 }
 
 /*
- * Create map of instrument banks and program numbers with their associated
- * file names from the XML files for a quick access during playback.
+ * Read the patches of an ensemble file, this is done the first time the
+ * ensemble program is requested.
  */
 void
-MIDIDriver::read_ensemble(program_map_t& bank, const char* name, const char* ensemble_file, uint16_t bank_no, int program_no)
+MIDIDriver::read_ensemble(ensemble_map_t& ensemble, const char* name, const char* ensemble_file)
 {
     std::filesystem::path path = midi.info(AAX_SHARED_DATA_DIR);
     path.append(ensemble_file);
@@ -941,7 +1097,6 @@ MIDIDriver::read_ensemble(program_map_t& bank, const char* name, const char* ens
 
             float pan = xmlAttributeGetDouble(xlid, "pan");
 
-            ensemble_map_t ensemble;
             char note_off[64] = "";
             char note_on[64] = "";
 //          char name[64] = "";
@@ -1015,10 +1170,6 @@ MIDIDriver::read_ensemble(program_map_t& bank, const char* name, const char* ens
             }
             xmlFree(xpid);
             xmlFree(xlid);
-
-            if (ensemble.size() > 0) {
-                bank.insert({program_no, std::move(ensemble)});
-            }
         }
         else {
             ERROR("aeonwave/set/layer not found in: " << path);
@@ -1052,7 +1203,7 @@ MIDIDriver::get_drum(uint16_t bank_no, uint16_t& program_no, uint8_t note_no, bo
         if (bank_found)
         {
             program_map_t& bank = itb->second;
-            auto iti = bank.find(note_no);
+            auto iti = find_program(itb, drum_index, note_no);
             if (iti != bank.end())
             {
                 if (all || selection.empty() ||
@@ -1148,7 +1299,7 @@ MIDIDriver::get_instrument(uint16_t bank_no, uint8_t program_no, bool all)
         if (bank_found)
         {
             auto& bank = itb->second;
-            auto iti = bank.find(program_no+1);
+            auto iti = find_program(itb, instrument_index, program_no+1);
             if (iti != bank.end())
             {
                 if (all || selection.empty() ||
@@ -1260,14 +1411,19 @@ MIDIDriver::grep(const std::string& filename, const char* grep)
 }
 
 MIDIEnsemble&
-MIDIDriver::new_channel(uint8_t track_no, uint16_t bank_no, uint8_t program_no)
+MIDIDriver::new_channel(uint8_t track_no, uint16_t bank_no, uint8_t program_no,
+                        bool program_change)
 {
     bool drums = is_drums(track_no);
     auto it = channels.find(track_no);
+    float reverb_level = 0.0f;
     if (!drums && it != channels.end())
     {
-        it->second->finish();
-        if (it->second) AeonWave::remove(*it->second);
+        auto rit = reverb_channels.find(track_no);
+        if (rit != reverb_channels.end() && rit->second == it->second) {
+            reverb_level = it->second->get_reverb_level();
+        }
+        park_channel(track_no, it->second);
         channels.erase(it);
     }
 
@@ -1288,16 +1444,38 @@ MIDIDriver::new_channel(uint8_t track_no, uint16_t bank_no, uint8_t program_no)
     it = channels.find(track_no);
     if (it == channels.end())
     {
-        try {
-            auto ret = channels.insert(
-                { track_no, std::shared_ptr<MIDIEnsemble>(
+        std::shared_ptr<MIDIEnsemble> part;
+        if (!drums) part = unpark_channel(track_no, bank_no, program_no);
+        if (part) {
+            part->reset_controllers();
+        }
+        else
+        {
+            try {
+                part = std::shared_ptr<MIDIEnsemble>(
                                     new MIDIEnsemble(*this, buffer,
-                                          track_no, bank_no, program_no, drums))
-                } );
-            it = ret.first;
-            AeonWave::add(*it->second);
-        } catch(const std::invalid_argument& e) {
-            throw(e);
+                                          track_no, bank_no, program_no, drums));
+                AeonWave::add(*part);
+
+                // the scan only gathers the patches, the ensembles
+                // built during it are cleared by the rewind
+                if (program_change && !drums && !initialize && !grep_mode) {
+                    part->add_members();
+                }
+            } catch(const std::invalid_argument& e) {
+                throw(e);
+            }
+        }
+        it = channels.insert({ track_no, part }).first;
+
+        // the reverb send belongs to the channel, not to the program
+        if (reverb_level > 0.0f)
+        {
+            AeonWave::remove(*part);
+            part->set_reverb(*reverb_buffer);
+            part->set_reverb_level(reverb_level);
+            reverb.add(*part);
+            reverb_channels[track_no] = part;
         }
     }
 
@@ -1309,7 +1487,61 @@ MIDIDriver::new_channel(uint8_t track_no, uint16_t bank_no, uint8_t program_no)
     if (env && atoi(env)) {
         rv.set_note_finish(true);
     }
+    update_stats();
+
+    return rv;
+}
+
+// The ensemble keeps playing its released notes, an ensemble on the
+// reverb bus is moved back to the mixer to keep the bus per channel.
+// The pedals are released since the pedal-off events of the channel go
+// to the next ensemble, the notes they hold would never stop otherwise.
+void
+MIDIDriver::park_channel(uint16_t track_no, std::shared_ptr<MIDIEnsemble> part)
+{
+    part->set_hold(false);
+    part->set_sustain(false);
+    part->finish();
+
+    auto it = reverb_channels.find(track_no);
+    if (it != reverb_channels.end() && it->second == part)
+    {
+        reverb.remove(*part);
+        aax::Buffer& disabled = AeonWave::buffer("GM2/room0");
+        part->set_reverb(disabled);
+        AeonWave::add(*part);
+        reverb_channels.erase(it);
+    }
+
+    auto& parked = parked_channels[track_no];
+    parked.push_back(part);
+    if (parked.size() > MIDI_ENSEMBLE_CACHE_SIZE)
+    {
+        AeonWave::remove(*parked.front());
+        parked.erase(parked.begin());
+    }
+}
+
+std::shared_ptr<MIDIEnsemble>
+MIDIDriver::unpark_channel(uint16_t track_no, uint16_t bank_no, uint8_t program_no)
+{
+    std::shared_ptr<MIDIEnsemble> rv;
 
+    auto it = parked_channels.find(track_no);
+    if (it != parked_channels.end())
+    {
+        auto& parked = it->second;
+        for (auto p = parked.begin(); p != parked.end(); ++p)
+        {
+            if ((*p)->get_bank_no() == bank_no &&
+                (*p)->get_program_no() == program_no)
+            {
+                rv = *p;
+                parked.erase(p);
+                break;
+            }
+        }
+    }
     return rv;
 }
 
@@ -1357,11 +1589,20 @@ MIDIDriver::process(uint8_t track_no, uint8_t message, uint8_t note_no, uint8_t
     // Omni mode: Device responds to MIDI data regardless of channel
     if (message == MIDI_NOTE_ON && velocity) {
         if (is_track_active(track_no)) {
+            if (!initialize) {
+                statistics.note_on(track_no, note_no);
+                MIDITrace::instance().instant("note-on", "note", track_no,
+                                              "key", note_no);
+            }
             try {
-                channel(track_no).play(note_no, velocity);
-                if (channel(track_no).get_stereo()) {
+                auto& part = channel(track_no);
+                part.play(note_no, velocity);
+                if (part.get_stereo()) {
                     set_reverb_level(track_no, 1.0f);
                 }
+                if (!initialize) {
+                    statistics.voices(track_no, part.active_voices());
+                }
             } catch (const std::runtime_error &e) {
                 throw(e);
             }
@@ -1372,11 +1613,29 @@ MIDIDriver::process(uint8_t track_no, uint8_t message, uint8_t note_no, uint8_t
         if (message == MIDI_NOTE_ON) {
             velocity = 64;
         }
+        if (!initialize) {
+            statistics.note_off(track_no, note_no);
+            MIDITrace::instance().instant("note-off", "note", track_no,
+                                          "key", note_no);
+        }
         channel(track_no).stop(note_no, velocity);
     }
     return true;
 }
 
+void
+MIDIDriver::all_notes_off(uint16_t track_no)
+{
+    if (!initialize) {
+        statistics.all_notes_off(track_no);
+    }
+
+    auto it = channels.find(track_no);
+    if (it != channels.end()) {
+        it->second->finish();
+    }
+}
+
 const char*
 MIDIDriver::get_channel_type(uint16_t part_no)
 {
@@ -13,9 +13,17 @@
 
 #include <map>
 #include <chrono>
+#include <random>
 #include <filesystem>
+#include <memory_resource>
 
 #include <midi/shared.hpp>
+#include <midi/index.hpp>
+#include <midi/stats.hpp>
+#include <midi/trace.hpp>
+#include <midi/sysex.hpp>
+#include <midi/param.hpp>
+#include <midi/curves.hpp>
 
 #include "base/types.h"
 
@@ -25,44 +33,24 @@ namespace aeonwave
 class MIDIEnsemble;
 
 
+#define MIDI_SONG_ARENA_SIZE		(64*1024)
+#define MIDI_PARAM_CHANNELS		16
+#define MIDI_ENSEMBLE_CACHE_SIZE	4
+#define MIDI_STATS_VOICES_MSEC		100
+
 enum {
     MIDI_POLYPHONIC = 3,
     MIDI_MONOPHONIC
 };
 
-struct info_t
-{
-    info_t() = default;
-    ~info_t() = default;
-
-    std::string name;
-    std::string file;
-    std::string key_on;
-    std::string key_off;
-
-    float gain = 1.0f;
-    float pitch = 1.0f;
-    float velocity_fraction = 1.0f;
-
-    float pan = 0.0f;
-    float spread = 1.0f;
-    int wide = 0;
-
-    int count = 1;
-    int min_note = 0;
-    int max_note = 128;
-
-    bool stereo = false;
-    bool ensemble = false;
-};
-
 class MIDIDriver : public AeonWave
 {
 private:
-    using ensemble_map_t = std::vector<info_t>;
-    using program_map_t = std::map<int, ensemble_map_t>;
-    using bank_map_t = std::map<uint16_t, program_map_t>;
+    using ensemble_map_t = MIDIIndex::ensemble_map_t;
+    using program_map_t = MIDIIndex::program_map_t;
+    using bank_map_t = MIDIIndex::bank_map_t;
     using channel_map_t = std::map<uint16_t, std::shared_ptr<MIDIEnsemble>>;
+    using index_list_t = std::vector<std::unique_ptr<MIDIIndex>>;
 
 public:
     MIDIDriver(const char* n, const char *tnames = nullptr,
@@ -77,7 +65,13 @@ public:
 
     bool process(uint8_t channel, uint8_t message, uint8_t key, uint8_t velocity, bool omni);
 
-    MIDIEnsemble& new_channel(uint8_t channel, uint16_t bank, uint8_t program);
+    // release every note of the channel, sustained notes keep sounding
+    void all_notes_off(uint16_t channel);
+
+    // a program change builds the members of a new ensemble right away,
+    // other channels load them at their first note
+    MIDIEnsemble& new_channel(uint8_t channel, uint16_t bank, uint8_t program,
+                              bool program_change = false);
 
     MIDIEnsemble& channel(uint16_t channel_no);
 
@@ -103,7 +97,19 @@ public:
         return active_track.empty() ? true : is_avail(active_track, t);
     }
 
-    void read_ensemble(program_map_t& bank, const char* name, const char* file, uint16_t bank_no, int n);
+    void set_track_mute(uint16_t t, bool m) {
+        if (t >= muted_track.size()) muted_track.resize(t+1, false);
+        muted_track[t] = m;
+    }
+    void set_track_solo(int32_t t) { solo_track = t; }
+    void set_mute(bool m) { mute = m; }
+    bool is_track_muted(uint16_t t) {
+        if (mute) return true;
+        if (solo_track >= 0) return (t != solo_track);
+        return (t < muted_track.size()) ? muted_track[t] : false;
+    }
+
+    void read_ensemble(ensemble_map_t& ensemble, const char* name, const char* file);
     void read_instruments(std::string gmidi=std::string(), std::string gmdrums=std::string());
 
     void grep(const std::string& filename, const char* grep);
@@ -171,9 +177,14 @@ public:
     void set_format(uint16_t fmt) { format = fmt; }
     uint16_t get_format() { return format; }
 
-    void set_tempo(uint32_t t) { tempo = t; uSPP = t/PPQN; }
+    void set_tempo(uint32_t t) { tempo = t; uSPP = t/(PPQN*tempo_scale); }
     int32_t get_tempo() { return tempo; }
 
+    void set_tempo_scale(float s) {
+        if (s > 0.0f) { tempo_scale = s; set_tempo(tempo); }
+    }
+    float get_tempo_scale() { return tempo_scale; }
+
     void set_uspp(uint32_t uspp) { uSPP = uspp; }
     int32_t get_uspp() { return uSPP; }
 
@@ -251,9 +262,42 @@ public:
     void set_display_data(std::string& s) { display_data = s; }
     std::string& get_display_data() { return display_data; }
 
+    // the counters are updated by the sequencer thread only,
+    // get_stats() may be called from any thread
+    MIDIStats& stats() { return statistics; }
+    void get_stats(aaxMIDIStats& s) { statistics.get(s); }
+    void update_stats();
+    void update_voices();
+
+    // the RPN and NRPN state of a MIDI channel, shared by all tracks
+    MIDIParams& get_params(uint8_t channel_no) {
+        return params[channel_no % MIDI_PARAM_CHANNELS];
+    }
+
+    // the controller conversion tables of a MIDI channel
+    MIDICurves& get_curves(uint8_t channel_no) {
+        return curves[channel_no % MIDI_PARAM_CHANNELS];
+    }
+
+    // shared by all tracks, seeding a generator per track is expensive
+    std::mt19937& get_random() { return m_mt; }
+
+    // storage for the text of the song, it is released all at once when
+    // the song gets rewound so nothing in it may outlive a rewind
+    std::pmr::memory_resource& get_song_arena() { return song_arena; }
+
+    // the GS or XG parameter memory of the sound module
+    MIDISysexImage& get_sysex_image(uint8_t type) {
+        return (type == XG) ? XG_image : GS_image;
+    }
+
 private:
     void set_path();
 
+    bool read_index(MIDIIndex& index, const std::string& filename, const std::string& type);
+    void add_index(std::unique_ptr<MIDIIndex>& index, bank_map_t& map, index_list_t& list);
+    program_map_t::iterator find_program(bank_map_t::iterator itb, index_list_t& list, int program_no);
+
     std::string preset_file(aaxConfig c, std::string& name) {
         std::string rv = midi.info(AAX_SHARED_DATA_DIR);
         rv.append("/"); rv.append(name);
@@ -279,12 +323,24 @@ private:
     channel_map_t delay_channels;
     channel_map_t reverb_channels;
 
+    // ensembles of earlier programs of a melodic channel, least recently
+    // used first. They stay in the mixer graph to finish their notes and
+    // are reused when the program gets selected again.
+    using ensemble_list_t = std::vector<std::shared_ptr<MIDIEnsemble>>;
+    std::map<uint16_t, ensemble_list_t> parked_channels;
+    void park_channel(uint16_t channel_no, std::shared_ptr<MIDIEnsemble>);
+    std::shared_ptr<MIDIEnsemble> unpark_channel(uint16_t channel_no,
+                                                 uint16_t bank, uint8_t program);
+
     // banks name and submixer filter and effects file
     program_map_t configuration_map;
 
     bank_map_t drum_map;
     bank_map_t instrument_map;
 
+    index_list_t drum_index;
+    index_list_t instrument_index;
+
     std::vector<uint16_t> missing_drum_bank;
     std::vector<uint16_t> missing_instrument_bank;
 
@@ -296,6 +352,9 @@ private:
 
     std::vector<std::string> selection;
     std::vector<uint16_t> active_track;
+    std::vector<bool> muted_track;
+    int32_t solo_track = -1;
+    bool mute = false;
 
     std::string instr = "gmmidi.xml";
     std::string drum = "gmdrums.xml";
@@ -313,6 +372,7 @@ private:
     uint16_t PPQN = 24;
     uint32_t tempo = 500000;
     uint32_t uSPP = tempo/PPQN;
+    float tempo_scale = 1.0f;
     uint16_t format = 0;
 
     enum aaxCapabilities instrument_mode = AAX_RENDER_NORMAL;
@@ -355,6 +415,25 @@ private:
 
     static const std::vector<std::string> midi_channel_convention;
 
+    MIDIStats statistics;
+    MIDIStats::clock::time_point voices_time;
+
+    // system, part and drum setup parameters
+    MIDISysexImage GS_image = {
+        GSMIDI_SYSTEM_PARAMETER_CHANGE, GSMIDI_PARAMETER_CHANGE,
+        GSMIDI_DRUM_SETUP_PARAMETER_CHANGE
+    };
+    // system, effect and multi part parameters
+    MIDISysexImage XG_image = {
+        XGMIDI_SYSTEM, XGMIDI_EFFECT1, XGMIDI_MULTI_PART
+    };
+
+    std::array<MIDIParams, MIDI_PARAM_CHANNELS> params;
+    std::array<MIDICurves, MIDI_PARAM_CHANNELS> curves;
+
+    std::pmr::monotonic_buffer_resource song_arena{MIDI_SONG_ARENA_SIZE};
+    std::mt19937 m_mt{std::random_device()()};
+
     bool timer_started = false;
     std::chrono::time_point<std::chrono::system_clock> start_time;
 };
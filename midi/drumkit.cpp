@@ -0,0 +1,75 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave MIDI library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#include <midi/drumkit.hpp>
+
+using namespace aeonwave;
+
+namespace
+{
+
+constexpr uint16_t ANY_SET = 0xffff;
+
+struct exclusive_t
+{
+    uint16_t program_no;
+    uint8_t key;
+    uint8_t exclusive;
+};
+
+// The exclusive classes of the GS drum sets, the kits which are not
+// listed use the ones of the Standard Set.
+const exclusive_t exclusive_table[] = {
+    { 26, 42, 1 }, { 26, 44, 1 }, { 26, 46, 1 },	// Analog Set hi-hat
+    { 48, 27, 1 }, { 48, 28, 1 }, { 48, 29, 1 },	// Orchestra Set hi-hat
+    { 57, 41, 7 }, { 57, 42, 7 },			// SFX Set scratch
+
+    { ANY_SET, 29, 7 }, { ANY_SET, 30, 7 },		// scratch
+    { ANY_SET, 42, 1 }, { ANY_SET, 44, 1 }, { ANY_SET, 46, 1 }, // hi-hat
+    { ANY_SET, 71, 2 }, { ANY_SET, 72, 2 },		// whistle
+    { ANY_SET, 73, 3 }, { ANY_SET, 74, 3 },		// guiro
+    { ANY_SET, 78, 4 }, { ANY_SET, 79, 4 },		// cuica
+    { ANY_SET, 80, 5 }, { ANY_SET, 81, 5 },		// triangle
+    { ANY_SET, 86, 6 }, { ANY_SET, 87, 6 }		// surdo
+};
+
+} // namespace
+
+uint8_t
+MIDIDrumKit::default_exclusive(uint16_t program_no, uint8_t key)
+{
+    bool listed = false;
+    for (auto& it : exclusive_table)
+    {
+        if (it.program_no == program_no)
+        {
+            listed = true;
+            if (it.key == key) return it.exclusive;
+        }
+        else if (it.program_no == ANY_SET && !listed && it.key == key) {
+            return it.exclusive;
+        }
+    }
+    return 0;
+}
+
+void
+MIDIDrumKit::set(uint8_t key, Buffer* buffer, uint8_t excl)
+{
+    if (key >= MIDI_DRUM_KEYS) return;
+    if (excl >= MIDI_DRUM_EXCLUSIVE_CLASSES) excl = 0;
+
+    classes[exclusive[key]].reset(key);
+    if (excl) classes[excl].set(key);
+
+    buffers[key] = buffer;
+    exclusive[key] = excl;
+    done.set(key);
+}
+
@@ -0,0 +1,95 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave MIDI library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include <array>
+#include <bitset>
+
+#include <aax/aeonwave>
+
+namespace aeonwave
+{
+
+#define MIDI_DRUM_KEYS			128
+#define MIDI_DRUM_EXCLUSIVE_CLASSES	32
+
+/*
+ * The key table of the drum kit of one part.
+ *
+ * Every key is resolved once after the kit is selected, after that the
+ * buffer of a key is a plain table lookup. A key which could not be
+ * found is remembered as resolved without a buffer.
+ *
+ * Keys of the same exclusive class cut each other off, like the closed,
+ * pedal and open hi-hat. The class comes from the exclusive attribute of
+ * the drum XML file, keys without one get the class the built-in table
+ * assigns to them for the kit, see default_exclusive(). The keys of every
+ * class are kept as a bitmask so a choke only costs one mask operation.
+ */
+class MIDIDrumKit
+{
+public:
+    using keys_t = std::bitset<MIDI_DRUM_KEYS>;
+
+    MIDIDrumKit() { clear(); }
+
+    // Returns true if the kit changed, all keys are unresolved then.
+    bool select(uint16_t bank_no, uint16_t program_no)
+    {
+        if (bank_no == bank && program_no == program) return false;
+
+        bank = bank_no;
+        program = program_no;
+        clear();
+        return true;
+    }
+
+    inline bool resolved(uint8_t key) const { return done[key]; }
+    inline Buffer* get(uint8_t key) const { return buffers[key]; }
+
+    // buffer may be nullptr for a key which is not available.
+    void set(uint8_t key, Buffer* buffer, uint8_t exclusive);
+
+    // Marks key as playing and returns the playing keys it cuts off.
+    inline keys_t choke(uint8_t key)
+    {
+        keys_t rv = classes[exclusive[key]] & playing;
+        rv.reset(key);
+        playing &= ~rv;
+        playing.set(key);
+        return rv;
+    }
+
+    static uint8_t default_exclusive(uint16_t program_no, uint8_t key);
+
+private:
+    void clear()
+    {
+        buffers.fill(nullptr);
+        exclusive.fill(0);
+        for (auto& it : classes) it.reset();
+        playing.reset();
+        done.reset();
+    }
+
+    std::array<Buffer*, MIDI_DRUM_KEYS> buffers;
+    std::array<uint8_t, MIDI_DRUM_KEYS> exclusive;
+    std::array<keys_t, MIDI_DRUM_EXCLUSIVE_CLASSES> classes;
+    keys_t playing;
+    keys_t done;
+
+    uint16_t bank = 0xffff;
+    uint16_t program = 0xffff;
+};
+
+} // namespace aeonwave
+
@@ -19,15 +19,14 @@
 #include <midi/ensemble.hpp>
 
 using namespace aax;
+using policy_t = MIDIPolicyRuntime;
 
 MIDIEnsemble::MIDIEnsemble(MIDIDriver& ptr, Buffer &buffer,
                     uint8_t channel, uint16_t bank, uint8_t program, bool drums)
    : Ensemble(ptr, buffer, channel == MIDI_DRUMS_CHANNEL), midi(ptr),
      bank_no(bank), channel_no(channel), program_no(program)
 {
-    set_gain(aax::math::ln(100.0f/127.0f));
-    set_expression(aax::math::ln(127.0f/127.0f));
-    set_pan(0.0f/64.f);
+    reset_controllers();
     set_drums(channel == MIDI_DRUMS_CHANNEL ? true : drums);
     if (is_drums() && buffer) {
        Mixer::add(buffer);
@@ -35,6 +34,113 @@ MIDIEnsemble::MIDIEnsemble(MIDIDriver& ptr, Buffer &buffer,
     Mixer::set(AAX_PLAYING);
 }
 
+void
+MIDIEnsemble::reset_controllers()
+{
+    Ensemble::reset_controllers();
+    set_gain(aax::math::ln(100.0f/127.0f));
+    set_expression(aax::math::ln(127.0f/127.0f));
+    set_pan(0.0f/64.f);
+}
+
+// Builds the members of the ensemble for the current bank and program,
+// called at the program change so the first note does not have to.
+void
+MIDIEnsemble::add_members()
+{
+    bool all = midi.no_active_tracks() > 0;
+    auto& ens = midi.get_instrument(bank_no, program_no, all);
+    for (size_t n=0; n<ens.size(); ++n)
+    {
+        auto& i = ens[n];
+        bool cached = midi.buffer_avail(i.file);
+        auto start = MIDIStats::clock::now();
+        Buffer& buffer = midi.buffer(i.file);
+        if (!cached)
+        {
+            midi.stats().patch_load(start);
+            if (!midi.get_initialize()) {
+                MIDITrace::instance().span("patch-load", "loader",
+                                   start, -1, "program", program_no,
+                                   i.file.c_str());
+            }
+        }
+        if (buffer)
+        {
+            auto& m = Ensemble::add_member(buffer, i.pitch, i.gain, i.count);
+            m.set_note_minmax(i.min_note, i.max_note);
+            m.set_velocity_fraction(i.velocity_fraction);
+//          Ensemble::set_pan(i.pan);
+        } else {
+            ERROR("Unable to open: " << i.file);
+        }
+    }
+
+    if (ens.size())
+    {
+        add_key_noise(key_on, "note-on", ens[0], ens[0].key_on);
+        add_key_noise(key_off, "note-off", ens[0], ens[0].key_off);
+    }
+}
+
+void
+MIDIEnsemble::add_key_noise(key_noise_t& pool, const char *type,
+                            const info_t& inst, const std::string& file)
+{
+    if (pool.active || file.empty()) return;
+
+    MESSAGE(3, "Loading %s: %s file: %s\n",
+            inst.name.c_str(), type, file.c_str());
+
+    Buffer& buffer = midi.buffer(file);
+    if (!buffer)
+    {
+        ERROR("Unable to open: " << file);
+        return;
+    }
+
+    pool.wide = inst.wide;
+    for (auto& it : pool.voices)
+    {
+        it.emitter = Emitter(pool.wide ? AAX_ABSOLUTE : AAX_RELATIVE);
+        it.emitter.add(buffer);
+        it.emitter.tie(it.pitch, AAX_PITCH_EFFECT, AAX_PITCH);
+        Mixer::add(it.emitter);
+    }
+    pool.active = true;
+
+    pan.wide = inst.wide;
+}
+
+// Restarts the least recently used voice of the pool.
+void
+MIDIEnsemble::play_key_noise(key_noise_t& pool, int note_no, float velocity)
+{
+    if (!pool.active) return;
+
+    auto& voice = pool.voices[pool.next];
+    pool.next = (pool.next + 1) % pool.voices.size();
+
+    voice.pitch = buffer.get_pitch(note_no);
+
+    // panning
+    if (pool.wide)
+    {
+        float p = MIDICurves::pan(note_no);
+        if (p != voice.pan_prev)
+        {
+            pan.set(p, true);
+            voice.emitter.matrix(pan.mtx);
+            voice.pan_prev = p;
+        }
+    }
+
+    voice.emitter.set(AAX_PROCESSED);
+    voice.emitter.set(AAX_INITIALIZED);
+    voice.emitter.set(AAX_MIDI_ATTACK_VELOCITY_FACTOR, velocity);
+    voice.emitter.set(AAX_PLAYING);
+}
+
 void
 MIDIEnsemble::set_stereo(bool s)
 {
@@ -53,18 +159,21 @@ MIDIEnsemble::play(int note_no, uint8_t velocity)
     assert (velocity);
 
     bool all = midi.no_active_tracks() > 0;
-    auto it = name_map.begin();
-    if (midi.channel(channel_no).is_drums())
+    bool drums = midi.channel(channel_no).is_drums();
+    Buffer *patch = nullptr;
+    if (drums)
     {
-        it = name_map.find(note_no);
-        if (it == name_map.end())
+        drum_kit.select(bank_no, program_no);
+        midi.stats().cache(drum_kit.resolved(note_no));
+        if (!drum_kit.resolved(note_no))
         {
             uint16_t program = program_no;
             auto& inst = midi.get_drum(bank_no, program, note_no, all);
             if (inst.size() && !inst[0].file.empty())
             {
                 const std::string& filename = inst[0].file;
-                if (!midi.buffer_avail(filename))
+                bool cached = midi.buffer_avail(filename);
+                if (!cached)
                 {
                     uint16_t bank_no = midi.channel(channel_no).get_bank_no();
                     const std::string& display = (midi.get_verbose() >= 99) ?
@@ -76,25 +185,40 @@ MIDIEnsemble::play(int note_no, uint8_t velocity)
                     midi.load(filename);
                 }
 
-                if (midi.get_grep())
-                {
-                   auto ret = name_map.insert({note_no,aax::nullBuffer});
-                   it = ret.first;
+                int exclusive = inst[0].exclusive;
+                if (!exclusive) {
+                    exclusive = MIDIDrumKit::default_exclusive(program_no, note_no);
+                }
+
+                if (midi.get_grep()) {
+                   drum_kit.set(note_no, &aax::nullBuffer, exclusive);
                 }
                 else
                 {
+                    auto start = MIDIStats::clock::now();
                     Buffer& buffer = midi.buffer(filename);
-                    if (buffer)
+                    if (!cached)
                     {
-                        auto ret = name_map.insert({note_no,buffer});
-                        it = ret.first;
+                        midi.stats().patch_load(start);
+                        if (!midi.get_initialize()) {
+                            MIDITrace::instance().span("patch-load", "loader",
+                                            start, -1, "key", note_no,
+                                            filename.c_str());
+                        }
+                    }
+                    if (buffer) {
+                        drum_kit.set(note_no, &buffer, exclusive);
                     }
                     else {
                         throw(std::invalid_argument("Instrument file "+filename+" could not load"));
                     }
                 }
             }
+            else {
+                drum_kit.set(note_no, nullptr, 0);
+            }
         }
+        patch = drum_kit.get(note_no);
     }
     else // !drums
     {
@@ -103,7 +227,9 @@ MIDIEnsemble::play(int note_no, uint8_t velocity)
         {
             const std::string& patch_file = inst[0].file;
             const std::string& patch_name = inst[0].name;
-            if (!midi.is_loaded(patch_name))
+            bool cached = midi.is_loaded(patch_name);
+            midi.stats().cache(cached);
+            if (!cached)
             {
                 uint16_t bank_no = midi.channel(channel_no).get_bank_no();
                 const std::string& display = (midi.get_verbose() >= 99) ?
@@ -123,16 +249,24 @@ MIDIEnsemble::play(int note_no, uint8_t velocity)
 
             if (midi.get_grep())
             {
-               auto ret = name_map.insert({note_no,aax::nullBuffer});
-               it = ret.first;
+               patch = &aax::nullBuffer;
             }
             else
             {
+                auto start = MIDIStats::clock::now();
                 Buffer& buffer = midi.buffer(patch_file);
+                if (!cached)
+                {
+                    midi.stats().patch_load(start);
+                    if (!midi.get_initialize()) {
+                        MIDITrace::instance().span("patch-load", "loader",
+                                           start, -1, "program", program_no,
+                                           patch_file.c_str());
+                    }
+                }
                 if (buffer)
                 {
-                    auto ret = name_map.insert({note_no,buffer});
-                    it = ret.first;
+                    patch = &buffer;
 
                     // mode == 0: volume bend only
                     // mode == 1: pitch bend only
@@ -157,192 +291,32 @@ MIDIEnsemble::play(int note_no, uint8_t velocity)
         }
     }
 
-    if (!midi.get_initialize() && it != name_map.end())
+    if (!midi.get_initialize() && patch)
     {
-        if (midi.channel(channel_no).is_drums())
+        if (drums)
         {
-            switch(program_no)
+            auto choked = drum_kit.choke(note_no);
+            if (choked.any())
             {
-            case 26: // Analog Set
-                switch(note_no)
-                {
-                case 42: // EXC1: Closed Hi-Hat
-                    Instrument::stop(44);
-                    Instrument::stop(46);
-                    break;
-                case 44: // EXC1: Pedal Hi-Hat
-                    Instrument::stop(42);
-                    Instrument::stop(46);
-                    break;
-                case 46: // EXC1: Open Hi-Hat
-                    Instrument::stop(42);
-                    Instrument::stop(44);
-                    break;
-                default:
-                    break;
-                }
-                break;
-            case 48: // Orchestra Set
-                switch(note_no)
-                {
-                case 27: // EXC1: Closed Hi-Hat
-                    Instrument::stop(28);
-                    Instrument::stop(29);
-                    break;
-                case 28: // EXC1: Pedal Hi-Ha
-                    Instrument::stop(27);
-                    Instrument::stop(29);
-                    break;
-                case 29: // EXC1: Open Hi-Hat
-                    Instrument::stop(27);
-                    Instrument::stop(28);
-                    break;
-                default:
-                    break;
-                }
-                break;
-            case 57: // SFX Set
-                switch(note_no)
-                {
-                case 41: // EXC7: Scratch Push
-                    Instrument::stop(42);
-                    break;
-                case 42: // EXC7: Scratch Pull
-                    Instrument::stop(41);
-                    break;
-                default:
-                    break;
+                for (int i=0; i<MIDI_DRUM_KEYS; ++i) {
+                    if (choked[i]) Ensemble::stop(i);
                 }
-                break;
-            case 0: // Standard Set
-            case 16: // Power set
-            case 32: // Jazz set
-            case 40: // Brush set
-            default:
-                switch(note_no)
-                {
-                case 29: // EXC7: Scratch Push
-                    Instrument::stop(30);
-                    break;
-                case 30: // EXC7: Scratch Pull
-                    Instrument::stop(29);
-                    break;
-                case 42: // EXC1: Closed Hi-Hat"
-                    Instrument::stop(44);
-                    Instrument::stop(46);
-                    break;
-                case 44: // EXC1: Pedal Hi-Hat
-                    Instrument::stop(42);
-                    Instrument::stop(46);
-                    break;
-                case 46: // EXC1: Open Hi-Hat
-                    Instrument::stop(42);
-                    Instrument::stop(44);
-                    break;
-                case 71: // EXC2: Short Whistle
-                    Instrument::stop(72);
-                    break;
-                case 72: // EXC2: Long Whistle
-                    Instrument::stop(71);
-                    break;
-                case 73: // EXC3: Short Guir
-                    Instrument::stop(74);
-                    break;
-                case 74: // EXC3: Long Guiro
-                    Instrument::stop(73);
-                    break;
-                case 78: // EXC4: Mute Cuica
-                    Instrument::stop(79);
-                    break;
-                case 79: // EXC4: Open Cuica
-                    Instrument::stop(78);
-                    break;
-                case 80: // EXC5: Mute Triangle
-                    Instrument::stop(81);
-                    break;
-                case 81: // EXC5: Open Triangle
-                    Instrument::stop(80);
-                    break;
-                case 86: // EXC6: Mute Surdo
-                    Instrument::stop(87);
-                    break;
-                case 87: // EXC6: Open Surdo
-                    Instrument::stop(86);
-                    break;
-                default:
-                    break;
-                }
-                break;
             }
 
-            Instrument::play(note_no, velocity, it->second);
+            Ensemble::play(note_no, velocity, *patch);
             return;
         }
 
+        // done at the program change, a channel which plays without
+        // one gets the members of its default program here
         if (Ensemble::no_members() == 0)
         {
-            bool all = midi.no_active_tracks() > 0;
-            auto& ens = midi.get_instrument(bank_no, program_no, all);
-            for (size_t n=0; n<ens.size(); ++n)
-            {
-                auto& i = ens[n];
-                Buffer& buffer = midi.buffer(i.file);
-                if (buffer)
-                {
-                    auto& m = Ensemble::add_member(buffer, i.pitch, i.gain, i.count);
-                    m->set_note_minmax(i.min_note, i.max_note);
-                    m->set_velocity_fraction(i.velocity_fraction);
-//                  Ensemble::set_pan(i.pan);
-                } else {
-                    ERROR("Unable to open: " << i.file);
-                }
-            }
+            add_members();
+            midi.update_stats();
         }
         Ensemble::play(note_no, velocity, 1.0f);
 
-        bool all = midi.no_active_tracks() > 0;
-        auto& inst = midi.get_instrument(bank_no, program_no, all);
-        if (inst.size() && !inst[0].key_on.empty())
-        {
-            const std::string& patch_name = inst[0].key_on;
-            bool wide = inst[0].wide;
-            if (!note_on)
-            {
-                note_on = Emitter(wide ? AAX_ABSOLUTE : AAX_RELATIVE);
-
-                std::string name = inst[0].name;
-                MESSAGE(3, "Loading %s: note-on file: %s\n",
-                        name.c_str(),  patch_name.c_str());
-                note_on.add( midi.buffer(patch_name) );
-                note_on.tie(note_on_pitch_param, AAX_PITCH_EFFECT, AAX_PITCH);
-
-                pan.wide = inst[0].wide;
-
-                Mixer::add(note_on);
-            }
-
-            // note2pitch
-            float note_frequency =  aax::math::note2freq(note_no);
-            note_on_pitch_param = buffer.get_pitch(note_no);
-
-            // panning
-            if (wide)
-            {
-                float p = (math::lin2log(note_frequency) - 1.3f)/2.8f; // 0.0f .. 1.0f
-                p = floorf(-2.0f*(p-0.5f)*note::pan_levels)/note::pan_levels;
-                if (p != pan_prev)
-                {
-                    pan.set(p, true);
-                    note_on.matrix(pan.mtx);
-                    pan_prev = p;
-                }
-            }
-
-            note_on.set(AAX_PROCESSED);
-            note_on.set(AAX_INITIALIZED);
-            note_on.set(AAX_MIDI_ATTACK_VELOCITY_FACTOR, 127.0f*velocity);
-            note_on.set(AAX_PLAYING);
-        }
+        play_key_noise(key_on, note_no, 127.0f*velocity);
     } else {
 //      throw(std::invalid_argument("Instrument file "+name+" not found"));
     }
@@ -354,47 +328,5 @@ MIDIEnsemble::stop(int note_no, uint8_t velocity)
     Ensemble::stop(note_no, velocity);
     if (is_drums()) return;
 
-    bool all = midi.no_active_tracks() > 0;
-    auto& inst = midi.get_instrument(bank_no, program_no, all);
-    if (inst.size() && !inst[0].key_off.empty())
-    {
-        const std::string& patch_name = inst[0].key_off;
-        bool wide = inst[0].wide;
-        if (!note_off)
-        {
-            note_off = Emitter(wide ? AAX_ABSOLUTE : AAX_RELATIVE);
-
-            std::string name = inst[0].name;
-            MESSAGE(3, "Loading %s: note-off file: %s\n",
-                    name.c_str(),  patch_name.c_str());
-            note_off.add( midi.buffer(patch_name) );
-            note_off.tie(note_off_pitch_param, AAX_PITCH_EFFECT, AAX_PITCH);
-
-            pan.wide = inst[0].wide;
-
-            Mixer::add(note_off);
-        }
-
-        // note2pitch
-        float note_frequency =  aax::math::note2freq(note_no);
-        note_off_pitch_param = buffer.get_pitch(note_no);
-
-        // panning
-        if (wide)
-        {   // 0.0f .. 1.0f
-            float p = (math::lin2log(note_frequency) - 1.3f)/2.8f;
-            p = floorf(-2.0f*(p-0.5f)*note::pan_levels)/note::pan_levels;
-            if (p != pan_prev)
-            {
-                pan.set(p, true);
-                note_off.matrix(pan.mtx);
-                pan_prev = p;
-            }
-        }
-
-        note_off.set(AAX_PROCESSED);
-        note_off.set(AAX_INITIALIZED);
-        note_off.set(AAX_MIDI_ATTACK_VELOCITY_FACTOR, 64.0f*velocity);
-        note_off.set(AAX_PLAYING);
-    }
+    play_key_noise(key_off, note_no, 64.0f*velocity);
 }
@@ -22,15 +22,20 @@
 
 #pragma once
 
-#include <map>
+#include <array>
+#include <string_view>
 
 #include <aax/instrument>
 
+#include <midi/drumkit.hpp>
+
 #include "base/types.h"
 
 namespace aeonwave
 {
 
+#define MIDI_KEY_NOISE_VOICES		4
+
 struct info_t;
 class MIDIDriver;
 
@@ -52,6 +57,11 @@ public:
 
     MIDIEnsemble& operator=(MIDIEnsemble&&) = default;
 
+    // restore the controllers a new ensemble starts with
+    void reset_controllers();
+
+    void add_members();
+
     void play(int note_no, uint8_t velocity);
     void stop(int note_no, uint8_t velocity = 0); // default to note off
 
@@ -64,23 +74,41 @@ public:
     uint16_t get_bank_no() { return bank_no; }
     void set_bank_no(uint16_t bank) { bank_no = bank; }
 
-    void set_track_name(std::string& tname) { track_name = tname; }
+    void set_track_name(std::string_view tname) { track_name = tname; }
 
     void set_stereo(bool s);
     bool get_stereo() { return stereo; }
 
 private:
-    std::map<uint8_t,Buffer&> name_map;
+    MIDIDrumKit drum_kit;
     std::string track_name;
 
     MIDIDriver &midi;
 
-    Emitter note_on;
-    Emitter note_off;
-    Param note_on_pitch_param = 1.0f;
-    Param note_off_pitch_param = 1.0f;
-
-    float pan_prev = -1000.0f;
+    // The key-on or key-off noise of the instrument. The voices are
+    // created at the program change and are used round-robin so that
+    // overlapping key noise does not cut itself off.
+    struct key_noise_t
+    {
+        struct voice_t
+        {
+            Emitter emitter;
+            Param pitch = 1.0f;
+            float pan_prev = -1000.0f;
+        };
+
+        std::array<voice_t, MIDI_KEY_NOISE_VOICES> voices;
+        size_t next = 0;
+        bool active = false;
+        bool wide = false;
+    };
+
+    void add_key_noise(key_noise_t& pool, const char *type,
+                       const info_t& inst, const std::string& file);
+    void play_key_noise(key_noise_t& pool, int note_no, float velocity);
+
+    key_noise_t key_on;
+    key_noise_t key_off;
 
     uint16_t bank_no = 0;
     uint16_t channel_no = 0;
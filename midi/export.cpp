@@ -0,0 +1,500 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave MIDI library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#include <cstring>
+
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include <midi/export.hpp>
+
+using namespace aeonwave;
+
+namespace
+{
+
+const char *text_name[] = {
+    "Text_t", "Copyright_t", "Title_t", "Instrument_name_t", "Lyric_t",
+    "Marker_t", "Cue_point_t", "Program_name_t", "Device_name_t"
+};
+
+const char digits[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233"
+    "34353637383940414243444546474849505152535455565758596061626364656667"
+    "6869707172737475767778798081828384858687888990919293949596979899";
+
+inline uint32_t
+read_long(const uint8_t *p)
+{
+    return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | p[2] << 8 | p[3];
+}
+
+inline uint16_t
+read_word(const uint8_t *p)
+{
+    return p[0] << 8 | p[1];
+}
+
+inline void
+need(const uint8_t *p, const uint8_t *end, size_t len)
+{
+    if (size_t(end - p) < len) {
+        throw(std::runtime_error("Premature end of track."));
+    }
+}
+
+// Variable-length quantity
+inline uint32_t
+read_vlq(const uint8_t *&p, const uint8_t *end)
+{
+    uint32_t rv = 0;
+    for (int i=0; i<4; ++i)
+    {
+        need(p, end, 1);
+        uint8_t byte = *p++;
+        rv = (rv << 7) | (byte & 0x7f);
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+    }
+    return rv;
+}
+
+} // namespace
+
+MIDIExport::MIDIExport(const char *filename)
+{
+    std::ifstream file(filename, std::ios::in|std::ios::binary);
+    if (!file) {
+        throw(std::runtime_error("Unable to open: "+std::string(filename)));
+    }
+    midi_data.assign(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+
+    const uint8_t *p = midi_data.data();
+    const uint8_t *end = p + midi_data.size();
+
+    if (midi_data.size() < 14 || read_long(p) != 0x4d546864) { // "MThd"
+        throw(std::runtime_error("Not a MIDI file: "+std::string(filename)));
+    }
+
+    uint32_t size = read_long(p+4);
+    if (size < 6 || size > size_t(end - p - 8)) {
+        throw(std::runtime_error("Premature end of file."));
+    }
+
+    format = read_word(p+8);
+    no_tracks = read_word(p+10);
+    division = read_word(p+12);
+    p += 8 + size;
+
+    // unknown chunk types are skipped, as the standard requires
+    while (size_t(end - p) >= 8)
+    {
+        uint32_t header = read_long(p);
+        size = read_long(p+4);
+        p += 8;
+
+        if (size > size_t(end - p)) {
+            throw(std::runtime_error("Premature end of file."));
+        }
+        if (header == 0x4d54726b) { // "MTrk"
+            chunks.push_back({p, size});
+        }
+        p += size;
+    }
+}
+
+void
+MIDIExport::write(FILE *fp, enum aaxMIDIExportFormat fmt)
+{
+    writer out(fp, fmt == AAX_MIDI_EXPORT_NDJSON);
+
+    out.begin(0, 0, "Header");
+    out.field("format", format);
+    out.field("tracks", chunks.size());
+    out.field("division", division);
+    out.end();
+
+    for (size_t i=0; i<chunks.size(); ++i) {
+        track(out, i+1, chunks[i]);
+    }
+
+    out.begin(0, 0, "End_of_file");
+    out.end();
+}
+
+void
+MIDIExport::track(writer& out, uint32_t track_no, const chunk_t& chunk)
+{
+    const uint8_t *p = chunk.data;
+    const uint8_t *end = p + chunk.size;
+    uint64_t time = 0;
+    uint8_t status = 0;
+
+    out.begin(track_no, 0, "Start_track");
+    out.end();
+
+    while (p < end)
+    {
+        time += read_vlq(p, end);
+
+        need(p, end, 1);
+        uint8_t message = *p;
+        if (message & 0x80)
+        {
+            ++p;
+            if (message < MIDI_SYSTEM_EXCLUSIVE) status = message;
+        }
+        else if (status) {
+            message = status;   // running status
+        }
+        else {
+            throw(std::runtime_error("Running status without a status byte."));
+        }
+
+        if (message < MIDI_SYSTEM_EXCLUSIVE)
+        {
+            uint8_t channel = message & 0xf;
+            uint8_t type = message & 0xf0;
+            size_t len = (type == MIDI_PROGRAM_CHANGE ||
+                          type == MIDI_CHANNEL_AFTERTOUCH) ? 1 : 2;
+            need(p, end, len);
+
+            switch(type)
+            {
+            case MIDI_NOTE_OFF:
+                out.begin(track_no, time, "Note_off_c");
+                out.field("channel", channel);
+                out.field("note", p[0]);
+                out.field("velocity", p[1]);
+                break;
+            case MIDI_NOTE_ON:
+                out.begin(track_no, time, "Note_on_c");
+                out.field("channel", channel);
+                out.field("note", p[0]);
+                out.field("velocity", p[1]);
+                break;
+            case MIDI_POLYPHONIC_AFTERTOUCH:
+                out.begin(track_no, time, "Poly_aftertouch_c");
+                out.field("channel", channel);
+                out.field("note", p[0]);
+                out.field("value", p[1]);
+                break;
+            case MIDI_CONTROL_CHANGE:
+                out.begin(track_no, time, "Control_c");
+                out.field("channel", channel);
+                out.field("control", p[0]);
+                out.field("value", p[1]);
+                break;
+            case MIDI_PROGRAM_CHANGE:
+                out.begin(track_no, time, "Program_c");
+                out.field("channel", channel);
+                out.field("program", p[0]);
+                break;
+            case MIDI_CHANNEL_AFTERTOUCH:
+                out.begin(track_no, time, "Channel_aftertouch_c");
+                out.field("channel", channel);
+                out.field("value", p[0]);
+                break;
+            case MIDI_PITCH_BEND:
+                out.begin(track_no, time, "Pitch_bend_c");
+                out.field("channel", channel);
+                out.field("value", (p[0] & 0x7f) | (p[1] & 0x7f) << 7);
+                break;
+            default:
+                break;
+            }
+            out.end();
+            p += len;
+        }
+        else if (message == MIDI_FILE_META_EVENT)
+        {
+            need(p, end, 1);
+            uint8_t type = *p++;
+            size_t len = read_vlq(p, end);
+            need(p, end, len);
+
+            meta(out, track_no, time, type, p, len);
+            p += len;
+
+            if (type == MIDI_END_OF_TRACK) break;
+        }
+        else if (message == MIDI_SYSTEM_EXCLUSIVE ||
+                 message == MIDI_SYSTEM_EXCLUSIVE_END)
+        {
+            size_t len = read_vlq(p, end);
+            need(p, end, len);
+
+            out.begin(track_no, time, (message == MIDI_SYSTEM_EXCLUSIVE)
+                                 ? "System_exclusive" : "System_exclusive_packet");
+            out.field("length", len);
+            out.bytes("data", p, len);
+            out.end();
+            p += len;
+        }
+        else {
+            throw(std::runtime_error("Unsupported status byte in a MIDI file."));
+        }
+    }
+}
+
+// Meta events which are too short for their type are written as unknown.
+void
+MIDIExport::meta(writer& out, uint32_t track_no, uint64_t time, uint8_t type,
+                 const uint8_t *data, size_t len)
+{
+    switch(type)
+    {
+    case MIDI_SEQUENCE_NUMBER:
+        out.begin(track_no, time, "Sequence_number");
+        out.field("number", (len >= 2) ? read_word(data) : 0);
+        break;
+    case MIDI_TEXT:
+    case MIDI_COPYRIGHT:
+    case MIDI_TRACK_NAME:
+    case MIDI_INSTRUMENT_NAME:
+    case MIDI_LYRICS:
+    case MIDI_MARKER:
+    case MIDI_CUE_POINT:
+    case MIDI_PROGRAM_NAME:
+    case MIDI_DEVICE_NAME:
+        out.begin(track_no, time, text_name[type - MIDI_TEXT]);
+        out.text("text", data, len);
+        break;
+    case MIDI_CHANNEL_PREFIX:
+        if (len < 1) goto unknown;
+        out.begin(track_no, time, "Channel_prefix");
+        out.field("number", data[0]);
+        break;
+    case MIDI_PORT_PREFERENCE:
+        if (len < 1) goto unknown;
+        out.begin(track_no, time, "MIDI_port");
+        out.field("number", data[0]);
+        break;
+    case MIDI_END_OF_TRACK:
+        out.begin(track_no, time, "End_track");
+        break;
+    case MIDI_SET_TEMPO:
+        if (len < 3) goto unknown;
+        out.begin(track_no, time, "Tempo");
+        out.field("number", data[0] << 16 | data[1] << 8 | data[2]);
+        break;
+    case MIDI_SMPTE_OFFSET:
+        if (len < 5) goto unknown;
+        out.begin(track_no, time, "SMPTE_offset");
+        out.field("hour", data[0]);
+        out.field("minute", data[1]);
+        out.field("second", data[2]);
+        out.field("frame", data[3]);
+        out.field("fraction", data[4]);
+        break;
+    case MIDI_TIME_SIGNATURE:
+        if (len < 4) goto unknown;
+        out.begin(track_no, time, "Time_signature");
+        out.field("numerator", data[0]);
+        out.field("denominator", data[1]);
+        out.field("click", data[2]);
+        out.field("notes_per_quarter", data[3]);
+        break;
+    case MIDI_KEY_SIGNATURE:
+        if (len < 2) goto unknown;
+        out.begin(track_no, time, "Key_signature");
+        out.field("key", int8_t(data[0]));
+        out.text("mode", (const uint8_t*)(data[1] ? "minor" : "major"), 5);
+        break;
+    case MIDI_SEQUENCERSPECIFICMETAEVENT:
+        out.begin(track_no, time, "Sequencer_specific");
+        out.field("length", len);
+        out.bytes("data", data, len);
+        break;
+    default:
+    unknown:
+        out.begin(track_no, time, "Unknown_meta_event");
+        out.field("type", type);
+        out.field("length", len);
+        out.bytes("data", data, len);
+        break;
+    }
+    out.end();
+}
+
+void
+MIDIExport::writer::begin(uint32_t track, uint64_t time, const char *type)
+{
+    if (json)
+    {
+        put("{\"track\":");
+        put_number(track);
+        put(",\"time\":");
+        put_number(time);
+        put(",\"type\":\"");
+        put(type);
+        reserve(1);
+        put('"');
+    }
+    else
+    {
+        put_number(track);
+        put(", ");
+        put_number(time);
+        put(", ");
+        put(type);
+    }
+}
+
+void
+MIDIExport::writer::field(const char *name, int64_t value)
+{
+    if (json)
+    {
+        put(",\"");
+        put(name);
+        put("\":");
+    }
+    else {
+        put(", ");
+    }
+    put_number(value);
+}
+
+// CSV text follows midicsv: quotes are doubled, backslashes and the bytes
+// which are not printable are written as an octal escape sequence.
+// JSON text has the bytes above 0x7f written as Latin-1 code points.
+void
+MIDIExport::writer::text(const char *name, const uint8_t *data, size_t len)
+{
+    if (json)
+    {
+        put(",\"");
+        put(name);
+        put("\":\"");
+    }
+    else {
+        put(", \"");
+    }
+
+    for (size_t i=0; i<len; ++i)
+    {
+        uint8_t c = data[i];
+
+        reserve(6);
+        if (json)
+        {
+            if (c == '"' || c == '\\') {
+                put('\\'); put(c);
+            } else if (c < ' ' || c > '~') {
+                static const char hex[] = "0123456789abcdef";
+                put('\\'); put('u'); put('0'); put('0');
+                put(hex[c >> 4]); put(hex[c & 0xf]);
+            } else {
+                put(c);
+            }
+        }
+        else
+        {
+            if (c == '"') {
+                put('"'); put('"');
+            } else if (c == '\\') {
+                put('\\'); put('\\');
+            } else if (c < ' ' || (c > '~' && c <= 160)) {
+                put('\\');
+                put('0' + (c >> 6)); put('0' + ((c >> 3) & 7)); put('0' + (c & 7));
+            } else {
+                put(c);
+            }
+        }
+    }
+
+    reserve(1);
+    put('"');
+}
+
+void
+MIDIExport::writer::bytes(const char *name, const uint8_t *data, size_t len)
+{
+    if (json)
+    {
+        put(",\"");
+        put(name);
+        put("\":[");
+        for (size_t i=0; i<len; ++i)
+        {
+            if (i) { reserve(1); put(','); }
+            put_number(data[i]);
+        }
+        reserve(1);
+        put(']');
+    }
+    else
+    {
+        for (size_t i=0; i<len; ++i)
+        {
+            put(", ");
+            put_number(data[i]);
+        }
+    }
+}
+
+void
+MIDIExport::writer::end()
+{
+    if (json) put("}\n");
+    else put("\n");
+}
+
+void
+MIDIExport::writer::put(const char *s)
+{
+    size_t len = strlen(s);
+    reserve(len);
+    memcpy(buffer.data() + pos, s, len);
+    pos += len;
+}
+
+// Two digits at a time, from the end of a scratch buffer.
+void
+MIDIExport::writer::put_number(int64_t v)
+{
+    char s[20];
+    char *p = s + sizeof(s);
+    uint64_t u = (v < 0) ? -uint64_t(v) : v;
+
+    while (u >= 100)
+    {
+        unsigned i = (u % 100)*2;
+        u /= 100;
+        *--p = digits[i+1];
+        *--p = digits[i];
+    }
+    if (u >= 10)
+    {
+        unsigned i = u*2;
+        *--p = digits[i+1];
+        *--p = digits[i];
+    }
+    else {
+        *--p = '0' + u;
+    }
+
+    size_t len = s + sizeof(s) - p;
+    reserve(len+1);
+    if (v < 0) put('-');
+    memcpy(buffer.data() + pos, p, len);
+    pos += len;
+}
+
+void
+MIDIExport::writer::flush()
+{
+    if (pos) fwrite(buffer.data(), 1, pos, fp);
+    pos = 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave MIDI library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+
+#include <vector>
+
+#include <aax/midi.h>
+
+namespace aeonwave
+{
+
+#define MIDI_EXPORT_BUFFER_SIZE		(1024*1024)
+
+/*
+ * Writes all events of a standard MIDI file as midicsv compatible CSV or
+ * as newline delimited JSON, one event per line.
+ *
+ * The tracks are decoded straight from the file data, one after the
+ * other, no audio device or instrument set is involved. The output is
+ * collected in a large buffer with its own integer formatting and only
+ * written to the file when the buffer is full.
+ *
+ * Times are in ticks, tracks are numbered from one and track zero holds
+ * the header and the end of file record. Errors in the file throw a
+ * std::runtime_error.
+ */
+class MIDIExport
+{
+public:
+    MIDIExport(const char *filename);
+    ~MIDIExport() = default;
+
+    void write(FILE *fp, enum aaxMIDIExportFormat format = AAX_MIDI_EXPORT_CSV);
+
+private:
+    struct chunk_t
+    {
+        const uint8_t *data;
+        size_t size;
+    };
+
+    class writer
+    {
+    public:
+        writer(FILE *f, bool j) : fp(f), json(j) {
+            buffer.resize(MIDI_EXPORT_BUFFER_SIZE);
+        }
+        ~writer() { flush(); }
+
+        void begin(uint32_t track, uint64_t time, const char *type);
+        void field(const char *name, int64_t value);
+        void text(const char *name, const uint8_t *data, size_t len);
+        void bytes(const char *name, const uint8_t *data, size_t len);
+        void end();
+
+        void flush();
+
+    private:
+        inline void reserve(size_t len) {
+            if (pos + len > buffer.size()) flush();
+        }
+        inline void put(char c) { buffer[pos++] = c; }
+        void put(const char *s);
+        void put_number(int64_t v);
+
+        std::vector<char> buffer;
+        size_t pos = 0;
+        FILE *fp;
+        bool json;
+    };
+
+    void track(writer& out, uint32_t track_no, const chunk_t& chunk);
+    void meta(writer& out, uint32_t track_no, uint64_t time, uint8_t type,
+              const uint8_t *data, size_t len);
+
+    std::vector<uint8_t> midi_data;
+    std::vector<chunk_t> chunks;
+
+    uint16_t format = 0;
+    uint16_t no_tracks = 0;
+    uint16_t division = 0;
+};
+
+} // namespace aeonwave
+
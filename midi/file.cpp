@@ -24,6 +24,10 @@
 #include <cassert>
 
 #include <fstream>
+#include <chrono>
+#include <queue>
+#include <thread>
+#include <functional>
 
 #include <aax/strings>
 
@@ -31,6 +35,7 @@
 #include <midi/file.hpp>
 
 using namespace aax;
+using policy_t = MIDIPolicyRuntime;
 
 MIDIFile::MIDIFile(const char *devname, const char *filename,
                    const char *selection, enum aaxRenderMode mode,
@@ -137,6 +142,7 @@ MIDIFile::MIDIFile(const char *devname, const char *filename,
                         }
                     }
                     no_tracks = track_no;
+                    frame_tracks();
 
                     midi.set_initialize(true);
                     CSV(track_no, "0, 0, Header, 0, %d, %d\n", no_tracks, PPQN);
@@ -177,6 +183,16 @@ MIDIFile::initialize(const char *grep)
         }
     }
 
+    env = getenv("AAX_MIDI_LOOKAHEAD");
+    if (env) {
+        lookahead_sec = _MAX(atof(env), 0.0);
+    }
+
+    env = getenv("AAX_MIDI_TIMELINE");
+    if (env) {
+        use_timeline = (atoi(env) != 0);
+    }
+
     // Read the overlay instruments
     if (!gmmidi.empty() || gmdrums.empty()) {
        midi.read_instruments(gmmidi, gmdrums);
@@ -206,6 +222,7 @@ MIDIFile::initialize(const char *grep)
     eps = (double)(clock() - t)/ CLOCKS_PER_SEC;
 
     midi.set_initialize(false);
+    midi.stats().reset();
 
     if (!grep)
     {
@@ -253,9 +270,9 @@ MIDIFile::initialize(const char *grep)
             MESSAGE(1, "Patch set : %s", midi.get_patch_set().c_str());
             MESSAGE(1, " instrument set version %s\n", midi.get_patch_version().c_str());
             MESSAGE(1, "Render Mode: ");
-            if (capabilities & AAX_RENDER_SYNTHESIZER) printf("Synthesizer\n");
-            else if (capabilities & AAX_RENDER_ARCADE) printf("Arcade\n");
-            else printf("Normal\n");
+            if (capabilities & AAX_RENDER_SYNTHESIZER) MESSAGE(1, "Synthesizer\n");
+            else if (capabilities & AAX_RENDER_ARCADE) MESSAGE(1, "Arcade\n");
+            else MESSAGE(1, "Normal\n");
             MESSAGE(1, "Directory : %s\n", midi.info(AAX_SHARED_DATA_DIR));
 
             int hour, minutes, seconds;
@@ -287,26 +304,113 @@ MIDIFile::initialize(const char *grep)
 void
 MIDIFile::rewind()
 {
+    parser_stop();
+    timeline_pos = 0;
+
     midi.rewind();
     midi.set_lyrics(false);
     for (auto& it : streams) {
         it->rewind();
     }
+    time_offs_parts = 0;
+}
+
+// Fast forward from the start of the song up to pos seconds without
+// producing any sound. Returns the number of parts until the next event.
+uint32_t
+MIDIFile::seek(float pos)
+{
+    char verbose = midi.get_verbose();
+    uint64_t time_parts = 0;
+    uint32_t wait_parts = 1000000;
+
+    rewind();
+    pos_sec = 0.0f;
+
+    midi.set_mute(true);
+    midi.set_verbose(0);
+    try
+    {
+        while (pos_sec < pos && (play_timeline()
+                                 ? process_events(time_parts, wait_parts)
+                                 : process_tracks(time_parts, wait_parts, wait_parts)))
+        {
+            time_parts += wait_parts;
+            pos_sec += wait_parts*midi.get_uspp()*midi.get_tempo_scale()*1e-6f;
+        }
+    } catch (const std::runtime_error &e) {
+        midi.set_verbose(verbose);
+        midi.set_mute(false);
+        throw(e);
+    }
+    midi.set_verbose(verbose);
+    midi.set_mute(false);
+
+    seek_parts = time_parts;
+    return wait_parts;
 }
 
+// Returns true if the song position was changed.
 bool
-MIDIFile::process(uint64_t time_parts, uint32_t& next)
+MIDIFile::process_commands(uint64_t time_parts, uint32_t& next)
 {
-    uint32_t elapsed_parts = next;
-    uint32_t wait_parts;
     bool rv = false;
+    command_t cmd;
 
-    if (streams.size() == 0)
+    while (commands.pop(cmd))
     {
-        throw(std::runtime_error("No streams to process"));
-        return rv;
+        switch(cmd.type)
+        {
+        case MIDI_COMMAND_PAUSE:
+            if (!paused)
+            {
+                midi.set(AAX_SUSPENDED);
+                paused = true;
+            }
+            break;
+        case MIDI_COMMAND_RESUME:
+            if (paused)
+            {
+                midi.set(AAX_PLAYING);
+                paused = false;
+            }
+            break;
+        case MIDI_COMMAND_SEEK:
+        {
+            uint32_t wait_parts = seek(cmd.value);
+
+            // map the time of the next call onto the new song position
+            time_offs_parts = time_parts + wait_parts - seek_parts;
+            next = wait_parts;
+            rv = true;
+            break;
+        }
+        case MIDI_COMMAND_VOLUME:
+            midi.set_volume(cmd.value);
+            break;
+        case MIDI_COMMAND_TRACK_MUTE:
+            midi.set_track_mute(cmd.track, cmd.value);
+            break;
+        case MIDI_COMMAND_TRACK_SOLO:
+            midi.set_track_solo(cmd.track);
+            break;
+        case MIDI_COMMAND_TEMPO_SCALE:
+            midi.set_tempo_scale(cmd.value);
+            break;
+        default:
+            break;
+        }
     }
 
+    return rv;
+}
+
+bool
+MIDIFile::process_tracks(uint64_t time_parts, uint32_t elapsed_parts, uint32_t& next)
+{
+    uint32_t wait_parts;
+    bool rv = false;
+
     next = UINT_MAX;
     for (size_t t=0; t<no_tracks; ++t)
     {
@@ -342,37 +446,512 @@ MIDIFile::process(uint64_t time_parts, uint32_t& next)
         next = 100;
     }
 
-    if (midi.get_verbose() && (!midi.get_lyrics() || midi.elapsed_time(5.0)))
+    return rv;
+}
+
+// Variable-length quantity, returns false at the end of the track
+static bool
+pull_vlq(const uint8_t *data, size_t size, size_t& pos, uint32_t& rv)
+{
+    rv = 0;
+    for (int i=0; i<4; ++i)
+    {
+        if (pos >= size) return false;
+
+        uint8_t byte = data[pos++];
+        rv = (rv << 7) | (byte & 0x7f);
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+    }
+    return true;
+}
+
+// Skip the event at pos without interpreting it, the status byte is
+// resolved in the same way as MIDIStream::process_event() does.
+static bool
+skip_event(const uint8_t *data, size_t size, size_t& pos, uint8_t& previous)
+{
+    uint32_t len = 0;
+
+    if (pos >= size) return false;
+
+    uint8_t message = data[pos++];
+    if ((message & 0x80) == 0)
+    {
+        --pos;
+        message = previous;
+    }
+    else if ((message & 0xF0) != 0xF0) {
+        previous = message;
+    }
+
+    switch(message)
+    {
+    case MIDI_SYSTEM_EXCLUSIVE:
+    case MIDI_SYSTEM_EXCLUSIVE_END:
+        if (!pull_vlq(data, size, pos, len)) return false;
+        break;
+    case MIDI_FILE_META_EVENT:
+        ++pos; // type
+        if (!pull_vlq(data, size, pos, len)) return false;
+        break;
+    case MIDI_SYSTEM|MIDI_TIMING_CODE:
+    case MIDI_SYSTEM|MIDI_SONG_SELECT:
+        len = 1;
+        break;
+    case MIDI_SYSTEM|MIDI_POSITION_POINTER:
+        len = 2;
+        break;
+    default:
+        switch(message & 0xf0)
+        {
+        case MIDI_SYSTEM:
+            break;
+        case MIDI_PROGRAM_CHANGE:
+        case MIDI_CHANNEL_AFTERTOUCH:
+            len = 1;
+            break;
+        default:
+            len = 2;
+            break;
+        }
+        break;
+    }
+
+    pos += len;
+    return (pos <= size);
+}
+
+// Returns true if the SMPTE offset meta event at pos delays the start
+// of the track, which only MIDIStream::process() takes into account.
+// A frame offset of less than one second counts as a delay too.
+static bool
+smpte_delay(const uint8_t *data, size_t size, size_t pos)
+{
+    if (pos+8 > size || data[pos+2] != 5) return false;
+
+    // an offset of one hour means start immediately
+    uint8_t hr = data[pos+3] & 0x1f;
+    return (hr > 1 || data[pos+4] || data[pos+5] || data[pos+6] || data[pos+7]);
+}
+
+// Frame all events of one track. The track ends at the end of track
+// meta event, or just before an event which does not fit in the track.
+// largest is set to the size of the longest message of the track.
+// Returns true if the track starts with a delay.
+static bool
+frame_track(const uint8_t *data, size_t size, size_t pos,
+            uint64_t time_parts, uint16_t track, std::vector<event_t>& events,
+            size_t& largest)
+{
+    uint8_t previous = 0;
+    bool rv = false;
+
+    largest = 0;
+    while (pos < size)
+    {
+        bool running = ((data[pos] & 0x80) == 0);
+        event_t e = { time_parts, uint32_t(pos), track,
+                      running ? previous : data[pos] };
+        bool meta = (data[pos] == MIDI_FILE_META_EVENT && pos+1 < size);
+        bool end = (meta && data[pos+1] == MIDI_END_OF_TRACK);
+        if (meta && data[pos+1] == MIDI_SMPTE_OFFSET) {
+            rv |= smpte_delay(data, size, pos);
+        }
+        if (!skip_event(data, size, pos, previous)) break;
+
+        events.push_back(e);
+        largest = _MAX(largest, pos - e.offset + running);
+
+        uint32_t wait_parts;
+        if (end || !pull_vlq(data, size, pos, wait_parts)) break;
+        time_parts += wait_parts;
+    }
+    return rv;
+}
+
+// The tracks are framed in parallel and then merged into the timeline.
+// Ties are resolved in track order, just like process_tracks() does,
+// and the events of one track keep their order. So tempo changes and
+// system exclusive messages of the first track always come before the
+// events of the other tracks at the same time.
+void
+MIDIFile::frame_tracks()
+{
+    std::vector<std::vector<event_t>> tracks(streams.size());
+    std::vector<size_t> largest(streams.size(), 0);
+    std::atomic<size_t> next_track{0};
+
+    track_data.clear();
+    for (auto& s : streams) {
+        track_data.emplace_back((uint8_t*)*s, s->size());
+    }
+    std::atomic<bool> delayed{false};
+
+    auto worker = [&]() {
+        size_t t;
+        while ((t = next_track.fetch_add(1)) < streams.size())
+        {
+            MIDIStream& s = *streams[t];
+            if (frame_track((uint8_t*)s, s.size(), s.offset(),
+                            s.get_timestamp_parts(), t, tracks[t],
+                            largest[t])) {
+                delayed = true;
+            }
+        }
+    };
+
+    size_t no_threads = _MIN(std::thread::hardware_concurrency(), streams.size());
+    std::vector<std::thread> pool;
+    for (size_t i=1; i<no_threads; ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& it : pool) {
+        it.join();
+    }
+    smpte_offset = delayed;
+
+    // every message has to fit in the arena of the look-ahead parser
+    size_t arena_size = MIDI_LOOKAHEAD_ARENA_SIZE;
+    for (size_t len : largest) {
+        arena_size = _MAX(arena_size, len);
+    }
+    arena.resize(arena_size);
+
+    // k-way merge
+    using head_t = std::pair<uint64_t, uint16_t>;
+    std::priority_queue<head_t, std::vector<head_t>, std::greater<head_t>> heads;
+    std::vector<size_t> pos(tracks.size(), 0);
+    size_t total = 0;
+    for (size_t t=0; t<tracks.size(); ++t)
+    {
+        total += tracks[t].size();
+        if (!tracks[t].empty()) heads.emplace(tracks[t][0].time_parts, t);
+    }
+
+    timeline.clear();
+    timeline.reserve(total);
+    while (!heads.empty())
+    {
+        uint16_t t = heads.top().second;
+        heads.pop();
+
+        // take every event of this track up to the next track in line
+        std::vector<event_t>& events = tracks[t];
+        size_t& i = pos[t];
+        do {
+            timeline.push_back(events[i++]);
+        } while (i < events.size() && (heads.empty() ||
+                 head_t(events[i].time_parts, t) < heads.top()));
+
+        if (i < events.size()) heads.emplace(events[i].time_parts, t);
+    }
+    timeline_pos = 0;
+}
+
+// Dispatch the events of the timeline which are due. The CSV export
+// never uses the timeline, see play_timeline().
+bool
+MIDIFile::process_events(uint64_t time_parts, uint32_t& next)
+{
+    if (!midi.get_initialize()) {
+        return process_events<MIDIPolicyPlay>(time_parts, next);
+    }
+    return process_events<MIDIPolicyScan>(time_parts, next);
+}
+
+template<class policy_t>
+bool
+MIDIFile::process_events(uint64_t time_parts, uint32_t& next)
+{
+    while (timeline_pos < timeline.size() &&
+           timeline[timeline_pos].time_parts <= time_parts)
+    {
+        const event_t& e = timeline[timeline_pos++];
+        streams[e.track]->dispatch<policy_t>(e.offset);
+    }
+
+    if (timeline_pos < timeline.size())
+    {
+        next = timeline[timeline_pos].time_parts - time_parts;
+        return true;
+    }
+
+    next = 100;
+    return !finished();
+}
+
+// Returns true when every track played all of its events and all the
+// notes have stopped playing.
+bool
+MIDIFile::finished()
+{
+    bool rv = true;
+    for (size_t t=0; t<no_tracks; ++t)
     {
-        std::string text = midi.get_display_data();
-        int len = text.size();
-        char display[41] = "";
-        if (len < 16) {
-            snprintf(display, 40, "%-32s", text.c_str());
+        if (t || !midi.get_format()) {
+            rv &= midi.finished(streams[t]->get_channel_no());
         }
-        else
+    }
+    return rv;
+}
+
+// The size of the message of a framed event including its status byte.
+size_t
+MIDIFile::message_size(const event_t& e)
+{
+    uint8_map& track = track_data[e.track];
+    const uint8_t *data = track;
+    size_t pos = e.offset;
+    uint8_t previous = e.status;
+
+    skip_event(data, track.size(), pos, previous);
+    return pos - e.offset + ((data[e.offset] & 0x80) == 0);
+}
+
+// Copy the message of an event into the queued event, or into the arena
+// when it does not fit, with its status byte resolved. This way the
+// sequencer thread only dispatches complete messages and never has to
+// read a track itself. The arena must have room for the message.
+void
+MIDIFile::extract(const event_t& e, size_t size, queued_t& q)
+{
+    uint8_map& track = track_data[e.track];
+    const uint8_t *data = track;
+    bool running = ((data[e.offset] & 0x80) == 0);
+    uint8_t *ptr = q.message;
+
+    q.time_parts = e.time_parts;
+    q.track = e.track;
+    q.len = size;
+    if (q.len > MIDI_QUEUED_MESSAGE_MAX)
+    {
+        arena.alloc(q.len, q.arena_pos);
+        ptr = arena.get(q.arena_pos);
+    }
+
+    if (running) *ptr++ = e.status;
+    memcpy(ptr, data+e.offset, q.len - running);
+}
+
+// Wake up a thread which waits on parse_mutex. Taking the mutex makes
+// sure a waiting thread either sees the new state or gets notified.
+void
+MIDIFile::parser_wake(std::condition_variable& cv)
+{
+    { std::lock_guard<std::mutex> lock(parse_mutex); }
+    cv.notify_one();
+}
+
+// Look-ahead parser thread: queue the events of the timeline up to the
+// horizon which is set by the sequencer thread. The parser sleeps until
+// the sequencer moves the horizon or makes room in the event ring.
+void
+MIDIFile::parser()
+{
+    size_t pos = queued_pos;
+    size_t len = 0;
+    while (pos < timeline.size())
+    {
         {
-            snprintf(display, 40, "%32s", "");
-            sprintf(display, "%s %s", text.substr(0, 16).c_str(),
-                                      text.substr(16, 16).c_str());
+            std::unique_lock<std::mutex> lock(parse_mutex);
+            parse_cv.wait(lock, [&] {
+                return !parsing || (events.size() < events.capacity() &&
+                                    arena.room(len) &&
+                                    timeline[pos].time_parts <= horizon_parts);
+            });
         }
+        if (!parsing) break;
 
-        int hour, minutes, seconds;
+        uint64_t horizon = horizon_parts;
+        while (pos < timeline.size() && timeline[pos].time_parts <= horizon)
+        {
+            // the sequencer thread only ever makes room
+            size_t size = message_size(timeline[pos]);
+            len = (size > MIDI_QUEUED_MESSAGE_MAX) ? size : 0;
+            if (events.size() == events.capacity() || !arena.room(len)) {
+                break;
+            }
 
-        pos_sec += elapsed_parts*midi.get_uspp()*1e-6f;
+            queued_t q;
+            extract(timeline[pos], size, q);
+            events.push(q);
 
-        seconds = pos_sec;
-        hour = seconds/(60*60);
-        seconds -= hour*60*60;
-        minutes = seconds/60;
-        seconds -= minutes*60;
-        if (hour) {
-            MESSAGE(1, "pos: %02i:%02i:%02i hours %s\r", hour, minutes, seconds, display);
-        } else {
-            MESSAGE(1, "pos: %02i:%02i minutes %s\r", minutes, seconds, display);
+            queued_pos.store(++pos, std::memory_order_release);
+            len = 0;
+        }
+        parser_wake(queue_cv);
+    }
+}
+
+// Continue from wherever the timeline is now, which is either the start
+// of the song or the position of the last seek.
+void
+MIDIFile::parser_start(uint64_t horizon)
+{
+    events.clear();
+    arena.clear();
+    queued_pos = timeline_pos;
+    horizon_parts = horizon;
+    parsing = true;
+    parse_thread = std::thread(&MIDIFile::parser, this);
+}
+
+void
+MIDIFile::parser_stop()
+{
+    if (parse_thread.joinable())
+    {
+        parsing = false;
+        parser_wake(parse_cv);
+        parse_thread.join();
+    }
+    parsing = false;
+    events.clear();
+    arena.clear();
+}
+
+// Dispatch the events the look-ahead parser has queued so far.
+bool
+MIDIFile::process_lookahead(uint64_t time_parts, uint32_t& next)
+{
+    // the window is converted to parts every time to follow tempo changes
+    float uspp = _MAX(midi.get_uspp()*midi.get_tempo_scale(), 1.0f);
+    uint64_t horizon = time_parts + uint64_t(lookahead_sec*1e6f/uspp);
+
+    if (!parsing) parser_start(horizon);
+    else horizon_parts = horizon;
+
+    for(;;)
+    {
+        queued_t *q;
+        while ((q = events.front()) != nullptr && q->time_parts <= time_parts)
+        {
+            if (q->len > MIDI_QUEUED_MESSAGE_MAX)
+            {
+                streams[q->track]->dispatch(arena.get(q->arena_pos), q->len);
+                arena.release(q->arena_pos + q->len);
+            }
+            else {
+                streams[q->track]->dispatch(q->message, q->len);
+            }
+            events.pop();
+        }
+        parser_wake(parse_cv);
+
+        if (q)
+        {
+            next = q->time_parts - time_parts;
+            return true;
+        }
+
+        // everything before the parser position was queued before it got
+        // stored, so with an empty ring pos is the next event to play
+        size_t pos = queued_pos.load(std::memory_order_acquire);
+        if (!events.empty()) continue;
+
+        if (pos == timeline.size()) break;
+        if (timeline[pos].time_parts > time_parts)
+        {
+            next = timeline[pos].time_parts - time_parts;
+            return true;
+        }
+
+        // the parser fell behind, wait until it queued the next event
+        std::unique_lock<std::mutex> lock(parse_mutex);
+        queue_cv.wait(lock, [&] {
+            return !events.empty() || queued_pos != pos || !parsing;
+        });
+        if (!parsing) break;
+    }
+
+    next = 100;
+    return !finished();
+}
+
+bool
+MIDIFile::process(uint64_t time_parts, uint32_t& next)
+{
+    stats_process_scope scope(midi.stats());
+    trace_scope trace("process", "sequencer", -1, nullptr,
+                      !midi.get_initialize());
+    uint32_t elapsed_parts = next;
+    bool rv = false;
+
+    midi.update_voices();
+
+    if (streams.size() == 0)
+    {
+        throw(std::runtime_error("No streams to process"));
+        return rv;
+    }
+
+    // time spent while paused does not advance the song position
+    if (paused)
+    {
+        time_offs_parts += elapsed_parts;
+        elapsed_parts = 0;
+    }
+
+    if (!commands.empty() && process_commands(time_parts, next)) {
+        return true;
+    }
+
+    // the initialization run and the grep option do not use the
+    // look-ahead parser, the CSV output is written per track
+    if (!play_timeline()) {
+        rv = process_tracks(time_parts - time_offs_parts, elapsed_parts, next);
+    } else if (lookahead_sec > 0.0f && !midi.get_initialize()) {
+        rv = process_lookahead(time_parts - time_offs_parts, next);
+    } else {
+        rv = process_events(time_parts - time_offs_parts, next);
+    }
+    if (paused)
+    {
+        // poll the command queue ten times per second
+        next = _MAX(100000/midi.get_uspp(), 1);
+        return true;
+    }
+
+    // print everything which is still queued before the final status line
+    if (!rv) MIDILog::instance().close();
+
+    if (midi.get_verbose() && (!midi.get_lyrics() || midi.elapsed_time(5.0)))
+    {
+        pos_sec += elapsed_parts*midi.get_uspp()*midi.get_tempo_scale()*1e-6f;
+
+        // the status line is shown at a fixed rate, skip the rest
+        if (!rv || MIDILog::instance().status_due())
+        {
+            std::string text = midi.get_display_data();
+            int len = text.size();
+            char display[41] = "";
+            if (len < 16) {
+                snprintf(display, 40, "%-32s", text.c_str());
+            }
+            else
+            {
+                snprintf(display, 40, "%32s", "");
+                sprintf(display, "%s %s", text.substr(0, 16).c_str(),
+                                          text.substr(16, 16).c_str());
+            }
+
+            int hour, minutes, seconds;
+
+            seconds = pos_sec;
+            hour = seconds/(60*60);
+            seconds -= hour*60*60;
+            minutes = seconds/60;
+            seconds -= minutes*60;
+            if (hour) {
+                STATUS("pos: %02i:%02i:%02i hours %s\r", hour, minutes, seconds, display);
+            } else {
+                STATUS("pos: %02i:%02i minutes %s\r", minutes, seconds, display);
+            }
+            if (!rv) MESSAGE(1, "\n\n");
         }
-        if (!rv) MESSAGE(1, "\n\n");
-        fflush(stdout);
     }
 
     if (!rv) CSV(0, "0, 0, End_of_file\n");
@@ -23,17 +23,65 @@
 #pragma once
 
 #include <map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 
 #include <aax/byte_stream.hpp>
 
 #include <midi/shared.hpp>
 #include <midi/driver.hpp>
+#include <midi/ring_buffer.hpp>
 
 namespace aeonwave
 {
 
 class MIDIStream;
 
+enum {
+    MIDI_COMMAND_PAUSE = 0,
+    MIDI_COMMAND_RESUME,
+    MIDI_COMMAND_SEEK,
+    MIDI_COMMAND_VOLUME,
+    MIDI_COMMAND_TRACK_MUTE,
+    MIDI_COMMAND_TRACK_SOLO,
+    MIDI_COMMAND_TEMPO_SCALE
+};
+
+struct command_t
+{
+    uint8_t type;
+    int32_t track;
+    float value;
+};
+
+// A framed event of the song timeline, offset points to the status
+// byte (or the first data byte for running status) within the track,
+// status is the status byte with running status resolved.
+struct event_t
+{
+    uint64_t time_parts;
+    uint32_t offset;
+    uint16_t track;
+    uint8_t status;
+};
+
+#define MIDI_QUEUED_MESSAGE_MAX		8
+#define MIDI_LOOKAHEAD_ARENA_SIZE	65536
+
+// An event queued by the look-ahead parser, copied from the track with
+// its status byte resolved. Channel messages and short meta events are
+// stored in message, longer messages like system exclusive dumps in the
+// arena of the parser.
+struct queued_t
+{
+    uint64_t time_parts;
+    uint64_t arena_pos;
+    uint32_t len;
+    uint16_t track;
+    uint8_t message[MIDI_QUEUED_MESSAGE_MAX];
+};
+
 class MIDIFile : public MIDIDriver
 {
 public:
@@ -44,15 +92,21 @@ public:
     explicit MIDIFile(std::string& devname, std::string& filename)
        :  MIDIFile(devname.c_str(), filename.c_str()) {}
 
-    virtual ~MIDIFile() = default;
+    virtual ~MIDIFile() { parser_stop(); MIDILog::instance().close(); }
 
     inline operator bool() {
         return midi_data.capacity();
     }
 
     void initialize(const char *grep = nullptr);
-    inline void start() { midi.start(); }
-    inline void stop() { midi.stop(); }
+    inline void start() {
+        if (midi.get_verbose()) MIDILog::instance().open();
+        midi.start();
+    }
+    inline void stop() {
+        midi.stop();
+        MIDILog::instance().close();
+    }
     void rewind();
 
     inline void set_volume(float g = 1.0f) { midi.set_volume(g); }
@@ -63,7 +117,98 @@ public:
 
     bool process(uint64_t, uint32_t&);
 
+    /*
+     * Thread safe control of a playing sequencer. The commands are queued
+     * and applied by the sequencer thread at the start of the next call
+     * to process(). Any number of threads may post commands, they only
+     * wait for each other and never for the sequencer thread. Returns
+     * false when the command queue is full.
+     */
+    bool post_pause() { return post(MIDI_COMMAND_PAUSE); }
+    bool post_resume() { return post(MIDI_COMMAND_RESUME); }
+    bool post_seek(float sec) { return post(MIDI_COMMAND_SEEK, -1, sec); }
+    bool post_volume(float g) { return post(MIDI_COMMAND_VOLUME, -1, g); }
+    bool post_track_mute(uint16_t t, bool m) {
+        return post(MIDI_COMMAND_TRACK_MUTE, t, m);
+    }
+    bool post_track_solo(int32_t t) { return post(MIDI_COMMAND_TRACK_SOLO, t); }
+    bool post_tempo_scale(float s) {
+        return post(MIDI_COMMAND_TEMPO_SCALE, -1, s);
+    }
+
+    inline bool is_paused() { return paused; }
+
+    /*
+     * How far the look-ahead parser may run ahead of the playhead, in
+     * seconds at the current tempo. A value of zero plays the timeline
+     * from the sequencer thread.
+     */
+    inline void set_lookahead(float sec) { lookahead_sec = sec; }
+    inline float get_lookahead() { return lookahead_sec; }
+
+    /*
+     * All tracks are framed and merged into one timeline when the file
+     * gets loaded. The timeline is played by default, without it every
+     * track is parsed on its own in the sequencer thread and there is
+     * no look-ahead parser. Songs with an SMPTE offset are always parsed
+     * per track.
+     */
+    inline void set_timeline(bool t) { use_timeline = t; }
+    inline bool get_timeline() { return use_timeline; }
+
 private:
+    // the command ring has a single producer side
+    bool post(uint8_t type, int32_t track = -1, float value = 0.0f) {
+        std::lock_guard<std::mutex> lock(post_mutex);
+        return commands.push({type, track, value});
+    }
+    bool process_commands(uint64_t, uint32_t&);
+    bool process_tracks(uint64_t, uint32_t, uint32_t&);
+    uint32_t seek(float);
+
+    bool process_events(uint64_t, uint32_t&);
+    template<class policy_t> bool process_events(uint64_t, uint32_t&);
+    bool process_lookahead(uint64_t, uint32_t&);
+    bool finished();
+    void frame_tracks();
+
+    inline bool play_timeline() {
+        return use_timeline && !smpte_offset && !midi.get_csv();
+    }
+
+    void parser_start(uint64_t);
+    void parser_stop();
+    void parser();
+    void parser_wake(std::condition_variable&);
+    size_t message_size(const event_t&);
+    void extract(const event_t&, size_t, queued_t&);
+
+    // the events of all tracks in the order in which they are played
+    std::vector<event_t> timeline;
+    size_t timeline_pos = 0;
+    bool use_timeline = true;
+    bool smpte_offset = false;
+
+    // the parser queues the timeline up to horizon_parts, queued_pos is
+    // the timeline position of the next event it has not queued yet
+    ring_buffer<queued_t, 4096> events;
+    ring_arena arena;
+    std::vector<uint8_map> track_data;
+    std::thread parse_thread;
+    std::mutex parse_mutex;
+    std::condition_variable parse_cv;
+    std::condition_variable queue_cv;
+    std::atomic<bool> parsing{false};
+    std::atomic<size_t> queued_pos{0};
+    std::atomic<uint64_t> horizon_parts{0};
+    float lookahead_sec = 1.0f;
+
+    ring_buffer<command_t, 64> commands;
+    std::mutex post_mutex;
+    int64_t time_offs_parts = 0;
+    uint64_t seek_parts = 0;
+    std::atomic<bool> paused{false};
+
     std::string file;
     std::string gmmidi;
     std::string gmdrums;
@@ -26,6 +26,7 @@
 #include <midi/driver.hpp>
 
 using namespace aax;
+using policy_t = MIDIPolicyRuntime;
 
 std::string MIDIStream::GM_initialize(uint8_t mode)
 {
@@ -44,7 +45,7 @@ std::string MIDIStream::GM_initialize(uint8_t mode)
 
         for (auto& it : midi.get_channels())
         {
-            midi.process(it.first, MIDI_NOTE_OFF, 0, 0, true);
+            midi.all_notes_off(it.first);
             midi.set_reverb_level(it.first, 0.0f);
             midi.set_chorus_level(it.first, 0.0f);
             it.second->set_expression(aax::math::ln(127.0f/127.0f));
@@ -70,7 +71,7 @@ std::string MIDIStream::GM_initialize(uint8_t mode)
 
         for (auto& it : midi.get_channels())
         {
-            midi.process(it.first, MIDI_NOTE_OFF, 0, 0, true);
+            midi.all_notes_off(it.first);
 
             midi.set_reverb_level(it.first, 0.0f);
             midi.set_chorus_level(it.first, 0.0f);
@@ -22,6 +22,7 @@
  */
 
 using namespace aax;
+using policy_t = MIDIPolicyRuntime;
 
 void MIDIStream::GS_initialize()
 {
@@ -36,7 +37,7 @@ void MIDIStream::GS_initialize()
 
     for (auto& it : midi.get_channels())
     {
-        midi.process(it.first, MIDI_NOTE_OFF, 0, 0, true);
+        midi.all_notes_off(it.first);
         it.second->set_expression(aax::math::ln(127.0f/127.0f));
         it.second->set_gain(aax::math::ln(100.0f/127.0f));
         it.second->set_pan(0.0f);
@@ -61,6 +62,8 @@ uint8_t MIDIStream::GS_Address2Part(uint8_t addr)
 
 bool MIDIStream::GS_process_sysex(uint64_t size, std::string& expl)
 {
+    // the explanation is only needed for the CSV output
+    bool csv = midi.get_csv(channel_no);
     bool rv = false;
     uint64_t offs = offset();
     uint8_t type;
@@ -102,6 +105,9 @@ bool MIDIStream::GS_process_sysex(uint64_t size, std::string& expl)
                 uint64_t sum = addr_high + addr_mid + addr_low + value;
                 CSV(channel_no, ", %d, %d, %d", addr_high, addr_mid, addr_low);
                 CSV(channel_no, ", %d", value);
+
+                auto& image = midi.get_sysex_image(GS);
+
                 switch (addr_high)
                 {
                 case GSMIDI_PARAMETER_CHANGE:
@@ -260,7 +266,7 @@ bool MIDIStream::GS_process_sysex(uint64_t size, std::string& expl)
                             rv = midi.set_chorus("GS/chorus-delay-feedback", value, GS);
                             break;
                         default:
-                            expl = "Unkown CHORUS_MACRO " + std::to_string(value);
+                            if (csv) expl = "Unkown CHORUS_MACRO " + std::to_string(value);
                             LOG(99, "LOG: Unsupported GS sysex Chorus type:"
                                     " 0x%02x (%d)\n", type, type);
                             break;
@@ -496,7 +502,7 @@ bool MIDIStream::GS_process_sysex(uint64_t size, std::string& expl)
                         {
                         case GSMIDI_EQUALIZER:
                             expl = "EQUALIZER";
-                            if (!equalizer_enabled) break;
+                            if (!enabled[SWITCH_EQUALIZER]) break;
                             if (GS_mode != 1) {
                                 GS_sysex_equalizer(part_no, addr_low, value);
                             }
@@ -514,15 +520,44 @@ bool MIDIStream::GS_process_sysex(uint64_t size, std::string& expl)
                             {
                             case GSMIDI_PART_SET:
                             case GSMIDI_PART_SWITCH:
-                                GS_sysex_part(part_no, addr_low, value, expl);
-                                expl = "PART_SET " + expl;
+                            {
+                                // data bytes left, including the checksum
+                                uint64_t len = offset()-offs;
+                                len = (len < size) ? size-len : 0;
+                                if (len > GS_part_param[addr_low & 0x7f].size)
+                                {   // more than one parameter: bulk write
+                                    std::vector<uint8_t> bulk(len);
+                                    bulk[0] = value;
+                                    for (size_t i=1; i<len; ++i) {
+                                        bulk[i] = pull_byte();
+                                        CSV(channel_no, ", %d", bulk[i]);
+                                    }
+                                    image.write(addr_high, addr_mid, addr_low,
+                                                bulk.data(), len, true);
+                                    GS_sysex_flush();
+                                    expl = "PART_SET BULK";
+                                }
+                                else
+                                {
+                                    uint8_t data[2];
+                                    uint8_t n = sysex_pull(GS_part_param,
+                                                           addr_low, value, data);
+                                    image.write(addr_high, addr_mid, addr_low,
+                                                data, n, false);
+
+                                    part_no = GS_Address2Part(addr_mid);
+                                    sysex_part(GS_part_param, addr_mid, part_no,
+                                               addr_low, data, expl);
+                                    if (csv) expl = "PART_SET " + expl;
+                                }
                                 break;
+                            }
                             case GSMIDI_MODULATION_SET:
                                 GS_sysex_modulation(part_no, addr_low, value, expl);
-                                expl = "MODULATION_SET " + expl;
+                                if (csv) expl = "MODULATION_SET " + expl;
                                break;
                             default:
-                                expl = "Unkown PARAMETER_CHANGE " + std::to_string(addr_mid & 0xF);
+                                if (csv) expl = "Unkown PARAMETER_CHANGE " + std::to_string(addr_mid & 0xF);
                                 LOG(99, "LOG: GS Data Set 1: Unsupported address:"
                                         " 0x%02x 0x%02x (%d %d)\n",
                                         addr_mid, addr_low, addr_mid, addr_low);
@@ -554,7 +589,7 @@ bool MIDIStream::GS_process_sysex(uint64_t size, std::string& expl)
                         GS_initialize();
                         break;
                     default:
-                        expl = "Unkown SYSTEM_PARAMETER_CHANGE " + std::to_string(addr);
+                        if (csv) expl = "Unkown SYSTEM_PARAMETER_CHANGE " + std::to_string(addr);
                         LOG(99, "LOG: Unsupported GS sysex system parameter change\n");
                         break;
                     }
@@ -587,7 +622,7 @@ bool MIDIStream::GS_process_sysex(uint64_t size, std::string& expl)
                     expl = "SYSTEM_INFORMATION";
                     break;
                 default:
-                    expl = "Unkown DATA_SET1 " + std::to_string(addr_high);
+                    if (csv) expl = "Unkown DATA_SET1 " + std::to_string(addr_high);
                     LOG(99, "LOG: Unsupported GS sysex effect type: 0x%02x 0x%02x 0x%02x (%d %d %d)\n",
                             addr_high, addr_mid, addr_low,
                             addr_high, addr_mid, addr_low);
@@ -600,7 +635,7 @@ bool MIDIStream::GS_process_sysex(uint64_t size, std::string& expl)
                 LOG(99, "LOG: Unsupported GS sysex data Request\n");
                 break;
             default:
-                expl = "Unkown MODEL_GS " + std::to_string(byte);
+                if (csv) expl = "Unkown MODEL_GS " + std::to_string(byte);
                 LOG(99, "LOG: Unsupported GS sysex parameter category: 0x%02x (%d)\n",
                      byte, byte);
                 break;
@@ -616,7 +651,7 @@ bool MIDIStream::GS_process_sysex(uint64_t size, std::string& expl)
         break;
     } // GSMIDI_SYSTEM
     default:
-        expl = "Unkown SYSEX " + std::to_string(type & 0xF);
+        if (csv) expl = "Unkown SYSEX " + std::to_string(type & 0xF);
         LOG(99, "LOG: Unsupported GS sysex category type: 0x%02x (%d)\n", type, type);
         break;
     }
@@ -871,7 +906,9 @@ MIDIStream::GS_sysex_insertion(uint8_t part_no, uint8_t addr, uint16_t type, std
     case GSMIDI_EFX_PARAMETER18:
     case GSMIDI_EFX_PARAMETER19:
     case GSMIDI_EFX_PARAMETER20:
-        expl = "EFX_PARAMETER" + std::to_string((addr - GSMIDI_EFX_PARAMETER1 + 1));
+        if (midi.get_csv(channel_no)) {
+            expl = "EFX_PARAMETER" + std::to_string(addr - GSMIDI_EFX_PARAMETER1 + 1);
+        }
         break;
     case GSMIDI_EFX_SEND_LEVEL_TO_REVERB:
         expl = "GSMIDI_EFX_SEND_LEVEL_TO_REVERB";
@@ -929,134 +966,84 @@ MIDIStream::GS_sysex_modulation(uint8_t part_no, uint8_t addr, uint8_t value, st
     return rv;
 }
 
-bool
-MIDIStream::GS_sysex_part(uint8_t part_no, uint8_t addr, uint8_t value, std::string &expl)
+// Applies the part parameters of a bulk write.
+void
+MIDIStream::GS_sysex_flush()
 {
-    auto& channel = midi.channel(part_no);
-    uint8_t byte;
-    bool rv = true;
-    switch(addr)
-    {
-    case GSMIDI_PART_TONE_NUMBER: // CC#00: MIDI_BANK_SELECT MSB
+    auto& image = midi.get_sysex_image(GS);
+    std::string expl;
+    int prev = -1;
+
+    image.flush([&](uint8_t high, uint8_t mid, uint8_t low)
     {
-        expl = "TONE_NUMBER";
-        bool prev = channel.is_drums();
-        bool drums = false;
+        if (high != GSMIDI_PARAMETER_CHANGE) return;
+        if ((mid & 0xF0) != GSMIDI_PART_SET &&
+            (mid & 0xF0) != GSMIDI_PART_SWITCH) return;
 
-        if (track_no == MIDI_DRUMS_CHANNEL) {
-            drums = true;
-        }
-        bank_no = value << 7;
+        // the second byte of a two byte parameter
+        if (GS_part_param[low].action == SYSEX_UNKNOWN && low &&
+            GS_part_param[low-1].size == 2) --low;
 
-        if (prev != drums)
-        {
-            channel.set_drums(drums);
-            std::string name = midi.get_channel_type(track_no);
-            MESSAGE(3, "Set part %i to %s\n", track_no, name.c_str());
-        }
+        if (GS_part_param[low].action == SYSEX_UNKNOWN) return;
+        if ((mid << 7 | low) == prev) return;
+        prev = mid << 7 | low;
+
+        uint8_t part_no = GS_Address2Part(mid);
+        sysex_part(GS_part_param, mid, part_no, low,
+                   image.get(high, mid, low), expl);
+    });
+}
 
-        uint8_t program_no = pull_byte();
-        CSV(channel_no, ", %d", program_no);
-        try {
-            midi.new_channel(channel_no, bank_no, program_no);
-            if (midi.is_drums(channel_no))
-            {
-                auto& frames = midi.get_configurations();
-                auto it = frames.find(program_no);
-                if (it != frames.end()) {
-                    name = it->second[0].name;
-                }
-            }
-            else
-            {
-                auto& inst = midi.get_instrument(bank_no, program_no);
-                if (inst.size()) name = inst[0].name;
-            }
-        } catch(const std::invalid_argument& e) {
-            ERROR("Error: " << e.what());
-        }
-        break;
-    }
-    case GSMIDI_PART_RX_CHANNEL: // 1 – 16, 0 = OFF
-        expl = "Unsupported RC CHANNEL";
-        LOG(99, "LOG: Unsupported GS sysex part channel\n");
-        break;
-    case GSMIDI_PART_PITCH_BEND_SWITCH:
-        expl = "PITCH_BEND_SWITCH";
-        pitch_bend_enabled  =value;
-        break;
-    case GSMIDI_PART_CHANNEL_PRESSURE_SWITCH:
-        expl = "CHANNEL_PRESSURE_SWITCH";
-        channel_pressure_enabled = value;
-        break;
-    case GSMIDI_PART_PROGRAM_CHANGE_SWITCH:
-        expl = "PROGRAM_CHANGE";
-        program_change_enabled = value;
-        break;
-    case GSMIDI_PART_CONTROL_CHANGE_SWITCH:
-        expl = "CONTROL_CHANGE_SWITCH";
-        control_change_enabled = value;
-        break;
-    case GSMIDI_PART_POLY_PRESSURE_SWITCH:
-        expl = "POLY_PRESSURE_SWITCH";
-        poly_pressure_enabled = value;
-        break;
-    case GSMIDI_PART_NOTE_MESSAGE_SWITCH:
-        expl = "NOTE_MESSAGE_SWITCH";
-        note_message_enabled = value;
-        break;
-    case GSMIDI_PART_RPN_SWITCH:
-        expl = "RPN_SWITCH";
-        rpn_enabled = value;
-        break;
-    case GSMIDI_PART_NRPN_SWITCH:
-        expl = "NRPN_SWITCH";
-        nrpn_enabled = value;
-        break;
-    case GSMIDI_PART_MODULATION_SWITCH:
-        expl = "MODULATION_SWITCH";
-        modulation_enabled = value;
-        break;
-    case GSMIDI_PART_VOLUME_SWITCH:
-        expl = "VOLUME_SWITCH";
-        volume_enabled = value;
-        break;
-    case GSMIDI_PART_PAN_SWITCH:
-        expl = "PAN_SWITCH";
-        pan_enabled = value;
-        break;
-    case GSMIDI_PART_EXPRESSION_SWITCH:
-        expl = "EXPRESSION_SWITCH";
-        expression_enabled = value;
-        break;
-    case GSMIDI_PART_HOLD1_SWITCH:
-        expl = "HOLD1_SWITCH";
-        hold1_enabled = value;
-        break;
-    case GSMIDI_PART_PORTAMENTO_SWITCH:
-        expl = "PORTAMENTO_SWITCH";
-        channel.set_pitch_slide_state(value >= 0x40);
-        break;
-    case GSMIDI_PART_SOSTENUTO_SWITCH:
-        expl = "SOSTENUTO_SWITCH";
-        sustain_enabled = true;
-        break;
-    case GSMIDI_PART_SOFT_SWITCH:
-        expl = "SOFT_SWITCH";
-        soft_enabled = true;
-        break;
-    case GSMIDI_PART_POLY_MODE:
-        expl = "POLY_MODE";
-        midi.process(part_no, MIDI_NOTE_OFF, 0, 0, true);
-        if (value == 0) {
-            mode = MIDI_MONOPHONIC;
-            channel.set_monophonic(true);
-        } else {
-            channel.set_monophonic(false);
-            mode = MIDI_POLYPHONIC;
-        }
-        break;
-    case GSMIDI_PART_ASSIGN_MODE:
+/*
+ * Part parameters, address: 0x40 0x1x 0xnn, x is the part.
+ * SC-8850_OM page 244
+ */
+const sysex_table_t MIDIStream::GS_part_param = make_sysex_table({
+  { GSMIDI_PART_TONE_NUMBER, GSMIDI_PART_TONE_NUMBER,
+    "TONE_NUMBER", SYSEX_TONE_NUMBER, 2 },
+  { GSMIDI_PART_RX_CHANNEL, GSMIDI_PART_RX_CHANNEL, "RX_CHANNEL", SYSEX_UNSUPPORTED },
+  { GSMIDI_PART_PITCH_BEND_SWITCH, GSMIDI_PART_PITCH_BEND_SWITCH,
+    "PITCH_BEND_SWITCH", SYSEX_SWITCH, 1, 1.0f, 0.0f,
+    SWITCH_PITCH_BEND },
+  { GSMIDI_PART_CHANNEL_PRESSURE_SWITCH, GSMIDI_PART_CHANNEL_PRESSURE_SWITCH,
+    "CHANNEL_PRESSURE_SWITCH", SYSEX_SWITCH, 1, 1.0f, 0.0f,
+    SWITCH_CHANNEL_PRESSURE },
+  { GSMIDI_PART_PROGRAM_CHANGE_SWITCH, GSMIDI_PART_PROGRAM_CHANGE_SWITCH,
+    "PROGRAM_CHANGE_SWITCH", SYSEX_SWITCH, 1, 1.0f, 0.0f,
+    SWITCH_PROGRAM_CHANGE },
+  { GSMIDI_PART_CONTROL_CHANGE_SWITCH, GSMIDI_PART_CONTROL_CHANGE_SWITCH,
+    "CONTROL_CHANGE_SWITCH", SYSEX_SWITCH, 1, 1.0f, 0.0f,
+    SWITCH_CONTROL_CHANGE },
+  { GSMIDI_PART_POLY_PRESSURE_SWITCH, GSMIDI_PART_POLY_PRESSURE_SWITCH,
+    "POLY_PRESSURE_SWITCH", SYSEX_SWITCH, 1, 1.0f, 0.0f,
+    SWITCH_POLY_PRESSURE },
+  { GSMIDI_PART_NOTE_MESSAGE_SWITCH, GSMIDI_PART_NOTE_MESSAGE_SWITCH,
+    "NOTE_MESSAGE_SWITCH", SYSEX_SWITCH, 1, 1.0f, 0.0f,
+    SWITCH_NOTE_MESSAGE },
+  { GSMIDI_PART_RPN_SWITCH, GSMIDI_PART_RPN_SWITCH,
+    "RPN_SWITCH", SYSEX_SWITCH, 1, 1.0f, 0.0f, SWITCH_RPN },
+  { GSMIDI_PART_NRPN_SWITCH, GSMIDI_PART_NRPN_SWITCH,
+    "NRPN_SWITCH", SYSEX_SWITCH, 1, 1.0f, 0.0f, SWITCH_NRPN },
+  { GSMIDI_PART_MODULATION_SWITCH, GSMIDI_PART_MODULATION_SWITCH,
+    "MODULATION_SWITCH", SYSEX_SWITCH, 1, 1.0f, 0.0f,
+    SWITCH_MODULATION },
+  { GSMIDI_PART_VOLUME_SWITCH, GSMIDI_PART_VOLUME_SWITCH,
+    "VOLUME_SWITCH", SYSEX_SWITCH, 1, 1.0f, 0.0f, SWITCH_VOLUME },
+  { GSMIDI_PART_PAN_SWITCH, GSMIDI_PART_PAN_SWITCH,
+    "PAN_SWITCH", SYSEX_SWITCH, 1, 1.0f, 0.0f, SWITCH_PAN },
+  { GSMIDI_PART_EXPRESSION_SWITCH, GSMIDI_PART_EXPRESSION_SWITCH,
+    "EXPRESSION_SWITCH", SYSEX_SWITCH, 1, 1.0f, 0.0f,
+    SWITCH_EXPRESSION },
+  { GSMIDI_PART_HOLD1_SWITCH, GSMIDI_PART_HOLD1_SWITCH,
+    "HOLD1_SWITCH", SYSEX_SWITCH, 1, 1.0f, 0.0f, SWITCH_HOLD1 },
+  { GSMIDI_PART_PORTAMENTO_SWITCH, GSMIDI_PART_PORTAMENTO_SWITCH,
+    "PORTAMENTO_SWITCH", SYSEX_PORTAMENTO },
+  { GSMIDI_PART_SOSTENUTO_SWITCH, GSMIDI_PART_SOSTENUTO_SWITCH,
+    "SOSTENUTO_SWITCH", SYSEX_SWITCH, 1, 1.0f, 0.0f,
+    SWITCH_SUSTAIN },
+  { GSMIDI_PART_SOFT_SWITCH, GSMIDI_PART_SOFT_SWITCH,
+    "SOFT_SWITCH", SYSEX_SWITCH, 1, 1.0f, 0.0f, SWITCH_SOFT },
+  { GSMIDI_PART_POLY_MODE, GSMIDI_PART_POLY_MODE, "POLY_MODE", SYSEX_POLY_MODE },
 /*
  * 0 = SINGLE               SC-8850/SC-88Pro/SC-88 MAP
  * 1 = LIMITED-MULTI        0                       LIMITED-MULTI
@@ -1080,182 +1067,72 @@ MIDIStream::GS_sysex_part(uint8_t part_no, uint8_t addr, uint8_t value, std::str
  *   This is initialized to a mode suitable for each Part, so for general
  *   purposes there is no need to change this.
  */
-        expl = "Unsupported ASSIGN_MODE";
-        break;
-    case GSMIDI_PART_RYTHM_MODE: // 0 = OFF, 1 = MAP1 , 2 = MAP2
-    {
-        expl = "RYTHM_MODE";
-        bool drums = value ? true : false;
-        midi.channel(part_no).set_drums(drums);
-        std::string name = midi.get_channel_type(part_no);
-        MESSAGE(3, "Set part %i to %s\n", part_no, name.c_str());
-        break;
-    }
-    case GSMIDI_PART_PITCH_KEY_SHIFT: // -24 - +24 [semitones], default: 40
-    {
-        expl = "PITCH_KEY_SHIFT";
-        float semitones = 24.0f * (float(value)-64.0f)/64.0f;
-        channel.set_tuning_coarse(semitones);
-        break;
-    }
-    case GSMIDI_PART_PITCH_OFFSET_FINE: // -12.0 - +12.0 [Hz], default 08 00
-    { // Allows you to alter, by a specified frequency amount,
-      // the pitch at which notes will sound.
-        expl = "PITCH_OFFSET_FINE";
-        int val = (value & 0xf) << 4;
-        byte = pull_byte();
-        CSV(channel_no, ", %d", byte);
-        val |= byte & 0xf;
-        channel.set_tuning_offset(12.0f * (val-0x80)/64.0f);
-        break;
-    }
-    case GSMIDI_PART_VOLUME:
-        expl = "VOLUME";
-        if (!volume_enabled) break;
-        channel.set_gain(aax::math::ln(float(value)/127.0f));
-        break;
-    case GSMIDI_PART_VELOCITY_SENSE_DEPTH:
-        expl = "Unsupported VELOCITY_SENSE_DEPTH";
-        break;
-    case GSMIDI_PART_VELOCITY_SENSE_OFFSET:
-        expl = "Unsupported VELOCITY_SENSE_OFFSET";
-        break;
-    case GSMIDI_PART_PAN: // -64 (RANDOM), -63 (LEFT) - +63 (RIGHT)
-        expl = "PAN";
-        if (!pan_enabled) break;
-        if (mode != MIDI_MONOPHONIC) {
-            if (value == -64) {
-                std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
-                channel.set_pan(dis(m_mt));
-            } else {
-                channel.set_pan((float(value)-63.f)/63.f);
-            }
-        }
-        break;
-    case GSMIDI_PART_KEYBOARD_RANGE_LOW:
-        expl = "KEYBOARD_RANGE_LOW";
-        key_range_low = value;
-        break;
-    case GSMIDI_PART_KEYBOARD_RANGE_HIGH:
-        expl = "KEYBOARD_RANGE_HIGH";
-        key_range_high = value;
-        break;
-    case GSMIDI_PART_CC1_CONTROL_NUMBER: // CC1 CONTROLLER NUMBER, default 10
-        expl = "Unsupported CC1_CONTROL_NUMBER";
-        break;
-    case GSMIDI_PART_CC2_CONTROL_NUMBER: // CC2 CONTROLLER NUMBER, default 11
-        expl = "Unsupported CC2_CONTROL_NUMBER";
-        break;
-    case GSMIDI_PART_CHORUS_SEND_LEVEL:
-        expl = "CHORUS_SEND_LEVEL";
-        midi.set_chorus_level(track_no, float(value)/127.0f);
-        break;
-    case GSMIDI_PART_REVERB_SEND_LEVEL:
-    {
-        expl = "REVERB_SEND_LEVEL";
-        float val = float(value)/127.0f;
-        midi.set_reverb_level(part_no, val);
-        break;
-    }
-    case GSMIDI_PART_BANK_SELECT_SWITCH:
-        expl = "BANK_SELECT_SWITCH";
-        bank_select_enabled = value;
-        break;
-    case GSMIDI_PART_BANK_SELECT_LSB_SWITCH:
-        expl = "BANK_SELECT_LSB_SWITCH";
-        bank_select_lsb_enabled = value;
-        break;
-    case GSMIDI_PART_PITCH_FINE_TUNE: // -100 - 0 - +100 [cents], default 40 00
-    {
-        expl = "PITCH_FINE_TUNE";
-        int val = (value & 0xf) << 4;
-        byte = pull_byte();
-        CSV(channel_no, ", %d", byte);
-        val |= byte & 0xf;
-        for(auto& it : midi.get_channels()) {
-            it.second->set_tuning_fine(100.0f * (val - 0x40)/64.0f);
-        }
-        break;
-    }
-    case GSMIDI_PART_DELAY_SEND_LEVEL:
-        expl = "Unsupported DELAY_SEND_LEVEL";
-        break;
-    case GSMIDI_PART_VIBRATO_RATE:
-    {
-        expl = "VIBRATO_RATE";
-        float val = 0.5f + float(value)/64.0f;
-        channel.set_vibrato_rate(val);
-        break;
-    }
-    case GSMIDI_PART_VIBRATO_DEPTH:
-    {
-        expl = "VIBRATO_DEPTH";
-        float val = float(value)/64.0f;
-        channel.set_vibrato_depth(val);
-        break;
-    }
-    case GSMIDI_PART_CUTOFF_FREQUENCY: // -64 - +63
-     { // Positive settings of Cutoff Freq will raise the cutoff frequency.
-       // Negative settings will lower the cutoff frequency.
-        expl = "CUTOFF_FREQUENCY";
-        float val = float(value)/64.0f;
-        if (val < 1.0f) val = 0.5f + 0.5f*val;
-        channel.set_filter_cutoff(val);
-        break;
-    }
-    case GSMIDI_PART_RESONANCE: // -64 - +63
-    {
-        expl = "RESONANCE";
-        float val = float(value)/64.0f;
-        channel.set_filter_resonance(val);
-        break;
-    }
-    case GSMIDI_PART_ATTACK_TIME:
-        expl = "ATTACK_TIME";
-        channel.set_attack_time(value);
-        break;
-    case GSMIDI_PART_DECAY_TIME:
-        expl = "DECAY_TIME";
-        channel.set_decay_time(value);
-        break;
-    case GSMIDI_PART_RELEASE_TIME:
-        expl = "RELEASE_TIME";
-        channel.set_release_time(value);
-        break;
-    case GSMIDI_PART_VIBRATO_DELAY:
-    {
-        expl = "VIBRATO_DELAY";
-        float val = float(value)/64.0f;
-        channel.set_vibrato_delay(val);
-        break;
-    }
-    case GSMIDI_PART_SCALE_TUNING_C:
-    case GSMIDI_PART_SCALE_TUNING_C_HASH:
-    case GSMIDI_PART_SCALE_TUNING_D:
-    case GSMIDI_PART_SCALE_TUNING_D_HASH:
-    case GSMIDI_PART_SCALE_TUNING_E:
-    case GSMIDI_PART_SCALE_TUNING_F:
-    case GSMIDI_PART_SCALE_TUNING_F_HASH:
-    case GSMIDI_PART_SCALE_TUNING_G:
-    case GSMIDI_PART_SCALE_TUNING_G_HASH:
-    case GSMIDI_PART_SCALE_TUNING_A:
-    case GSMIDI_PART_SCALE_TUNING_A_HASH:
-    case GSMIDI_PART_SCALE_TUNING_B:
-    { // Allows fine adjustment to the pitch of each note in the octave. The
-      // pitch of each identically-named note in all octaves will change
-      // simultaneously
-        expl = "GSMIDI_PART_SCALE";
-        int note = float(addr-GSMIDI_PART_SCALE_TUNING_C);
-        float cents = float(value)-64.0f; // -64 - 0 - +63 cents
-        channel.set_tuning_fine(cents, note);
-        break;
-    }
-    default:
-        expl = "Unknown " + std::to_string(addr);
-        LOG(99, "LOG: Unsupported GS sysex part set: 0x%02x (%d)\n", addr, addr);
-        rv = false;
-        break;
-    }
-    expl += ": " + std::to_string(value);
-    return rv;
-}
+  { GSMIDI_PART_ASSIGN_MODE, GSMIDI_PART_ASSIGN_MODE,
+    "ASSIGN_MODE", SYSEX_UNSUPPORTED },
+  // 0 = OFF, 1 = MAP1 , 2 = MAP2
+  { GSMIDI_PART_RYTHM_MODE, GSMIDI_PART_RYTHM_MODE, "RYTHM_MODE", SYSEX_DRUMS },
+  // -24 - +24 [semitones], default: 40
+  { GSMIDI_PART_PITCH_KEY_SHIFT, GSMIDI_PART_PITCH_KEY_SHIFT,
+    "PITCH_KEY_SHIFT", SYSEX_KEY_SHIFT, 1, 24.0f/64.0f, -24.0f },
+  // -12.0 - +12.0 [Hz], default 08 00
+  // Allows you to alter, by a specified frequency amount,
+  // the pitch at which notes will sound.
+  { GSMIDI_PART_PITCH_OFFSET_FINE, GSMIDI_PART_PITCH_OFFSET_FINE,
+    "PITCH_OFFSET_FINE", SYSEX_TUNING_OFFSET, 2, 12.0f/64.0f, -24.0f },
+  { GSMIDI_PART_VOLUME, GSMIDI_PART_VOLUME,
+    "VOLUME", SYSEX_GAIN, 1, 1.0f/127.0f, 0.0f, SWITCH_VOLUME },
+  { GSMIDI_PART_VELOCITY_SENSE_DEPTH, GSMIDI_PART_VELOCITY_SENSE_DEPTH,
+    "VELOCITY_SENSE_DEPTH", SYSEX_UNSUPPORTED },
+  { GSMIDI_PART_VELOCITY_SENSE_OFFSET, GSMIDI_PART_VELOCITY_SENSE_OFFSET,
+    "VELOCITY_SENSE_OFFSET", SYSEX_UNSUPPORTED },
+  // -64 (RANDOM), -63 (LEFT) - +63 (RIGHT)
+  { GSMIDI_PART_PAN, GSMIDI_PART_PAN,
+    "PAN", SYSEX_PAN, 1, 1.0f/63.0f, -1.0f, SWITCH_PAN },
+  { GSMIDI_PART_KEYBOARD_RANGE_LOW, GSMIDI_PART_KEYBOARD_RANGE_LOW,
+    "KEYBOARD_RANGE_LOW", SYSEX_KEY_RANGE_LOW },
+  { GSMIDI_PART_KEYBOARD_RANGE_HIGH, GSMIDI_PART_KEYBOARD_RANGE_HIGH,
+    "KEYBOARD_RANGE_HIGH", SYSEX_KEY_RANGE_HIGH },
+  // CC1 CONTROLLER NUMBER, default 10
+  { GSMIDI_PART_CC1_CONTROL_NUMBER, GSMIDI_PART_CC1_CONTROL_NUMBER,
+    "CC1_CONTROL_NUMBER", SYSEX_UNSUPPORTED },
+  // CC2 CONTROLLER NUMBER, default 11
+  { GSMIDI_PART_CC2_CONTROL_NUMBER, GSMIDI_PART_CC2_CONTROL_NUMBER,
+    "CC2_CONTROL_NUMBER", SYSEX_UNSUPPORTED },
+  { GSMIDI_PART_CHORUS_SEND_LEVEL, GSMIDI_PART_CHORUS_SEND_LEVEL,
+    "CHORUS_SEND_LEVEL", SYSEX_CHORUS_SEND, 1, 1.0f/127.0f },
+  { GSMIDI_PART_REVERB_SEND_LEVEL, GSMIDI_PART_REVERB_SEND_LEVEL,
+    "REVERB_SEND_LEVEL", SYSEX_REVERB_SEND, 1, 1.0f/127.0f },
+  { GSMIDI_PART_BANK_SELECT_SWITCH, GSMIDI_PART_BANK_SELECT_SWITCH,
+    "BANK_SELECT_SWITCH", SYSEX_SWITCH, 1, 1.0f, 0.0f,
+    SWITCH_BANK_SELECT },
+  { GSMIDI_PART_BANK_SELECT_LSB_SWITCH, GSMIDI_PART_BANK_SELECT_LSB_SWITCH,
+    "BANK_SELECT_LSB_SWITCH", SYSEX_SWITCH, 1, 1.0f, 0.0f,
+    SWITCH_BANK_SELECT_LSB },
+  // -100 - 0 - +100 [cents], default 40 00
+  { GSMIDI_PART_PITCH_FINE_TUNE, GSMIDI_PART_PITCH_FINE_TUNE,
+    "PITCH_FINE_TUNE", SYSEX_TUNING_FINE, 2, 100.0f/64.0f, -100.0f },
+  { GSMIDI_PART_DELAY_SEND_LEVEL, GSMIDI_PART_DELAY_SEND_LEVEL,
+    "DELAY_SEND_LEVEL", SYSEX_UNSUPPORTED },
+  { GSMIDI_PART_VIBRATO_RATE, GSMIDI_PART_VIBRATO_RATE,
+    "VIBRATO_RATE", SYSEX_VIBRATO_RATE, 1, 1.0f/64.0f, 0.5f },
+  { GSMIDI_PART_VIBRATO_DEPTH, GSMIDI_PART_VIBRATO_DEPTH,
+    "VIBRATO_DEPTH", SYSEX_VIBRATO_DEPTH, 1, 1.0f/64.0f },
+  // -64 - +63
+  { GSMIDI_PART_CUTOFF_FREQUENCY, GSMIDI_PART_CUTOFF_FREQUENCY,
+    "CUTOFF_FREQUENCY", SYSEX_FILTER_CUTOFF, 1, 1.0f/64.0f },
+  { GSMIDI_PART_RESONANCE, GSMIDI_PART_RESONANCE,
+    "RESONANCE", SYSEX_FILTER_RESONANCE, 1, 1.0f/64.0f },
+  { GSMIDI_PART_ATTACK_TIME, GSMIDI_PART_ATTACK_TIME,
+    "ATTACK_TIME", SYSEX_ATTACK_TIME },
+  { GSMIDI_PART_DECAY_TIME, GSMIDI_PART_DECAY_TIME,
+    "DECAY_TIME", SYSEX_DECAY_TIME },
+  { GSMIDI_PART_RELEASE_TIME, GSMIDI_PART_RELEASE_TIME,
+    "RELEASE_TIME", SYSEX_RELEASE_TIME },
+  { GSMIDI_PART_VIBRATO_DELAY, GSMIDI_PART_VIBRATO_DELAY,
+    "VIBRATO_DELAY", SYSEX_VIBRATO_DELAY, 1, 1.0f/64.0f },
+  // Allows fine adjustment to the pitch of each note in the octave. The
+  // pitch of each identically-named note in all octaves will change
+  // simultaneously, -64 - 0 - +63 cents
+  { GSMIDI_PART_SCALE_TUNING_C, GSMIDI_PART_SCALE_TUNING_B,
+    "SCALE_TUNING", SYSEX_SCALE_TUNING, 1, 1.0f, -64.0f }
+});
@@ -0,0 +1,627 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave MIDI library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstring>
+#include <cstdio>
+
+#ifndef WIN32
+# include <unistd.h>
+# include <fcntl.h>
+# include <sys/stat.h>
+# include <sys/mman.h>
+#else
+# include <fstream>
+#endif
+
+#include <random>
+#include <algorithm>
+#include <unordered_map>
+
+#include <midi/index.hpp>
+
+using namespace aeonwave;
+
+namespace
+{
+
+#define MIDI_INDEX_BYTE_ORDER		0x01020304
+#define MIDI_INDEX_ALIGN		8
+
+/*
+ * File layout: the header followed by the tables in the order below.
+ * All strings are stored as offsets into the string table where
+ * offset 0 is the empty string.
+ */
+struct header_t
+{
+    char magic[8];
+    uint32_t byte_order;
+    uint32_t version;
+    uint32_t size;
+    uint32_t type;
+
+    int32_t refresh_rate;
+    int32_t polyphony;
+    int32_t drum_set_no;
+    int32_t instrument_mode;
+    uint32_t patch_set;
+    uint32_t patch_version;
+    uint32_t effects;
+    uint32_t has_effects;
+
+    uint32_t no_deps, deps;
+    uint32_t no_configs, configs;
+    uint32_t no_banks, banks;
+    uint32_t no_programs, programs;
+    uint32_t no_patches, patches;
+    uint32_t strings, strings_size;
+};
+
+// the source file comes first, a missing file has an mtime of -1
+struct dep_t
+{
+    uint32_t path;
+    uint32_t reserved;
+    int64_t mtime;
+    uint64_t size;
+};
+
+struct config_t
+{
+    uint32_t bank_no;
+    uint32_t name;
+    uint32_t file;
+};
+
+struct bank_t
+{
+    uint32_t bank_no;
+    uint32_t first; // program
+    uint32_t count;
+};
+
+struct program_t
+{
+    int32_t program_no;
+    uint32_t first; // patch
+    uint32_t count;
+};
+
+struct patch_t
+{
+    uint32_t name;
+    uint32_t file;
+    uint32_t key_on;
+    uint32_t key_off;
+
+    float gain;
+    float pitch;
+    float velocity_fraction;
+    float pan;
+    float spread;
+
+    int32_t wide;
+    int32_t count;
+    int32_t min_note;
+    int32_t max_note;
+
+    uint8_t stereo;
+    uint8_t ensemble;
+    uint8_t include; // file is the ensemble file
+    uint8_t exclusive;
+};
+
+class string_table
+{
+public:
+    uint32_t add(const std::string& s)
+    {
+        if (s.empty()) return 0;
+
+        auto it = offsets.find(s);
+        if (it != offsets.end()) return it->second;
+
+        uint32_t rv = data.size();
+        data.insert(data.end(), s.c_str(), s.c_str()+s.size()+1);
+        offsets.insert({s, rv});
+        return rv;
+    }
+
+    std::vector<char> data = { '\0' };
+
+private:
+    std::unordered_map<std::string,uint32_t> offsets;
+};
+
+template <typename T>
+uint32_t
+append(std::vector<uint8_t>& out, const T *v, size_t num)
+{
+    out.resize((out.size()+MIDI_INDEX_ALIGN-1) & ~(MIDI_INDEX_ALIGN-1));
+
+    uint32_t rv = out.size();
+    const uint8_t *p = reinterpret_cast<const uint8_t*>(v);
+    out.insert(out.end(), p, p+num*sizeof(T));
+    return rv;
+}
+
+// Returns the table at offset offs if it fits in the data, or nullptr.
+template <typename T>
+const T*
+table(const uint8_t *data, size_t size, uint32_t offs, uint32_t num)
+{
+    if ((offs % alignof(T)) || offs > size || num > (size-offs)/sizeof(T)) {
+        return nullptr;
+    }
+    return reinterpret_cast<const T*>(data+offs);
+}
+
+bool
+get_stat(const std::filesystem::path& p, int64_t& mtime, uint64_t& size)
+{
+    std::error_code ec;
+    auto t = std::filesystem::last_write_time(p, ec);
+    if (!ec) size = std::filesystem::file_size(p, ec);
+    if (ec)
+    {
+        mtime = -1;
+        size = 0;
+        return false;
+    }
+    mtime = t.time_since_epoch().count();
+    return true;
+}
+
+} // namespace
+
+
+
+
+bool
+MIDIIndex::load()
+{
+    return load(cache_file(true)) || load(cache_file(false));
+}
+
+bool
+MIDIIndex::save()
+{
+    close();
+    image = write();
+    data = image.data();
+    size = image.size();
+    entries.clear();
+
+    return save(cache_file(true)) || save(cache_file(false));
+}
+
+void
+MIDIIndex::close()
+{
+#ifndef WIN32
+    if (mapped) munmap(mapped, size);
+#endif
+    mapped = nullptr;
+    image.clear();
+    data = nullptr;
+    size = 0;
+}
+
+/*
+ * The cache file is stored next to the XML file: gmmidi.xml -> gmmidi.idx
+ * or in the user cache directory with the hashed path of the XML file
+ * in the file name.
+ */
+std::filesystem::path
+MIDIIndex::cache_file(bool local)
+{
+    std::filesystem::path rv;
+    if (local)
+    {
+        rv = source;
+        rv.replace_extension(".idx");
+    }
+    else
+    {
+        const char *env = getenv("XDG_CACHE_HOME");
+        if (env) rv = env;
+        else
+        {
+#ifdef WIN32
+            env = getenv("LOCALAPPDATA");
+            if (env) rv = env;
+#else
+            env = getenv("HOME");
+            if (env) { rv = env; rv.append(".cache"); }
+#endif
+        }
+        if (rv.empty()) return rv;
+
+        std::error_code ec;
+        std::string name = std::filesystem::absolute(source, ec).string();
+        char hash[32];
+        snprintf(hash, sizeof(hash), "%016zx-",std::hash<std::string>{}(name));
+
+        rv.append("aeonwave");
+        rv.append(hash + source.stem().string() + ".idx");
+    }
+    return rv;
+}
+
+bool
+MIDIIndex::load(const std::filesystem::path& cache)
+{
+    bool rv = false;
+
+    if (cache.empty()) return rv;
+
+#ifndef WIN32
+    int fd = open(cache.c_str(), O_RDONLY);
+    if (fd < 0) return rv;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(header_t))
+    {
+        size_t len = st.st_size;
+        void *ptr = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr != MAP_FAILED)
+        {
+            rv = read(static_cast<const uint8_t*>(ptr), len);
+            if (rv)
+            {
+                close();
+                mapped = ptr;
+                data = static_cast<const uint8_t*>(ptr);
+                size = len;
+            }
+            else {
+                munmap(ptr, len);
+            }
+        }
+    }
+    ::close(fd);
+#else
+    std::ifstream file(cache, std::ios::binary);
+    if (file)
+    {
+        std::vector<uint8_t> buf((std::istreambuf_iterator<char>(file)),
+                                 std::istreambuf_iterator<char>());
+        if (buf.size() >= sizeof(header_t) && read(buf.data(), buf.size()))
+        {
+            close();
+            image = std::move(buf);
+            data = image.data();
+            size = image.size();
+            rv = true;
+        }
+    }
+#endif
+
+    if (!rv) configurations.clear();
+
+    return rv;
+}
+
+// Write to a temporary file first so other processes never see half a file.
+bool
+MIDIIndex::save(const std::filesystem::path& cache)
+{
+    if (cache.empty() || !data) return false;
+
+    std::error_code ec;
+    std::filesystem::create_directories(cache.parent_path(), ec);
+
+    std::filesystem::path tmp = cache;
+    tmp += ".tmp" + std::to_string(std::random_device()());
+
+    FILE *fp = fopen(tmp.string().c_str(), "wb");
+    if (!fp) return false;
+
+    bool rv = (fwrite(data, 1, size, fp) == size);
+    rv = (fclose(fp) == 0) && rv;
+    if (rv)
+    {
+        std::filesystem::rename(tmp, cache, ec);
+        rv = !ec;
+    }
+    if (!rv) std::filesystem::remove(tmp, ec);
+
+    return rv;
+}
+
+/*
+ * Check the image and read the settings. Every table is checked here
+ * so get() can use the image without further checks.
+ */
+bool
+MIDIIndex::read(const uint8_t *data, size_t size)
+{
+    const header_t *h = reinterpret_cast<const header_t*>(data);
+    if (memcmp(h->magic, MIDI_INDEX_MAGIC, sizeof(h->magic)) ||
+        h->byte_order != MIDI_INDEX_BYTE_ORDER ||
+        h->version != MIDI_INDEX_VERSION || h->size != size)
+    {
+        return false;
+    }
+
+    const char *strings = table<char>(data, size, h->strings, h->strings_size);
+    if (!strings || !h->strings_size || strings[h->strings_size-1] != '\0') {
+        return false;
+    }
+    auto str = [&](uint32_t offs) -> const char* {
+        return (offs < h->strings_size) ? strings+offs : "";
+    };
+
+    if (type != str(h->type)) return false;
+
+    // the source file must be unchanged
+    auto deps = table<dep_t>(data, size, h->deps, h->no_deps);
+    if (!deps || !h->no_deps) return false;
+
+    std::error_code ec;
+    if (std::filesystem::absolute(source, ec).string() != str(deps[0].path)) {
+        return false;
+    }
+
+    for (uint32_t i=0; i<h->no_deps; ++i)
+    {
+        int64_t mtime;
+        uint64_t fsize;
+        get_stat(str(deps[i].path), mtime, fsize);
+        if (mtime != deps[i].mtime || fsize != deps[i].size) return false;
+    }
+
+    auto configs = table<config_t>(data, size, h->configs, h->no_configs);
+    auto banks = table<bank_t>(data, size, h->banks, h->no_banks);
+    auto programs = table<program_t>(data, size, h->programs, h->no_programs);
+    auto patches = table<patch_t>(data, size, h->patches, h->no_patches);
+    if (!configs || !banks || !programs || !patches) return false;
+
+    for (uint32_t b=0; b<h->no_banks; ++b)
+    {
+        if (banks[b].first > h->no_programs ||
+            banks[b].count > h->no_programs-banks[b].first)
+        {
+            return false;
+        }
+    }
+    for (uint32_t p=0; p<h->no_programs; ++p)
+    {
+        if (programs[p].first > h->no_patches ||
+            programs[p].count > h->no_patches-programs[p].first)
+        {
+            return false;
+        }
+    }
+
+    for (uint32_t i=0; i<h->no_configs; ++i)
+    {
+        const config_t& c = configs[i];
+        info_t info;
+        info.name = str(c.name);
+        info.file = str(c.file);
+        configurations.insert({int(c.bank_no), {info}});
+    }
+
+    refresh_rate = h->refresh_rate;
+    polyphony = h->polyphony;
+    drum_set_no = h->drum_set_no;
+    instrument_mode = h->instrument_mode;
+    patch_set = str(h->patch_set);
+    patch_version = str(h->patch_version);
+    effects = str(h->effects);
+    has_effects = h->has_effects;
+
+    return true;
+}
+
+std::vector<uint8_t>
+MIDIIndex::write()
+{
+    string_table strings;
+    std::vector<dep_t> deps;
+    std::vector<config_t> configs;
+    std::vector<bank_t> banks;
+    std::vector<program_t> programs;
+    std::vector<patch_t> patches;
+
+    std::error_code ec;
+    dep_t dep = {};
+    dep.path = strings.add(std::filesystem::absolute(source, ec).string());
+    get_stat(source, dep.mtime, dep.size);
+    deps.push_back(dep);
+
+    for (auto& it : configurations)
+    {
+        if (it.second.empty()) continue;
+
+        config_t config;
+        config.bank_no = it.first;
+        config.name = strings.add(it.second[0].name);
+        config.file = strings.add(it.second[0].file);
+        configs.push_back(config);
+    }
+
+    // std::map keeps the banks and programs sorted for get()
+    for (auto& b : entries)
+    {
+        bank_t bank;
+        bank.bank_no = b.first;
+        bank.first = programs.size();
+        bank.count = b.second.size();
+        banks.push_back(bank);
+
+        for (auto& p : b.second)
+        {
+            program_t program;
+            program.program_no = p.first;
+            program.first = patches.size();
+            program.count = p.second.patches.size();
+            programs.push_back(program);
+
+            for (auto& info : p.second.patches)
+            {
+                patch_t patch = {};
+                patch.name = strings.add(info.name);
+                patch.file = strings.add(info.file);
+                patch.key_on = strings.add(info.key_on);
+                patch.key_off = strings.add(info.key_off);
+                patch.gain = info.gain;
+                patch.pitch = info.pitch;
+                patch.velocity_fraction = info.velocity_fraction;
+                patch.pan = info.pan;
+                patch.spread = info.spread;
+                patch.wide = info.wide;
+                patch.count = info.count;
+                patch.min_note = info.min_note;
+                patch.max_note = info.max_note;
+                patch.stereo = info.stereo;
+                patch.ensemble = info.ensemble;
+                patch.include = p.second.include;
+                patch.exclusive = info.exclusive;
+                patches.push_back(patch);
+            }
+        }
+    }
+
+    header_t h = {};
+    memcpy(h.magic, MIDI_INDEX_MAGIC, sizeof(h.magic));
+    h.byte_order = MIDI_INDEX_BYTE_ORDER;
+    h.version = MIDI_INDEX_VERSION;
+    h.type = strings.add(type);
+    h.refresh_rate = refresh_rate;
+    h.polyphony = polyphony;
+    h.drum_set_no = drum_set_no;
+    h.instrument_mode = instrument_mode;
+    h.patch_set = strings.add(patch_set);
+    h.patch_version = strings.add(patch_version);
+    h.effects = strings.add(effects);
+    h.has_effects = has_effects;
+
+    std::vector<uint8_t> rv(sizeof(header_t));
+    h.no_deps = deps.size();
+    h.deps = append(rv, deps.data(), deps.size());
+    h.no_configs = configs.size();
+    h.configs = append(rv, configs.data(), configs.size());
+    h.no_banks = banks.size();
+    h.banks = append(rv, banks.data(), banks.size());
+    h.no_programs = programs.size();
+    h.programs = append(rv, programs.data(), programs.size());
+    h.no_patches = patches.size();
+    h.patches = append(rv, patches.data(), patches.size());
+    h.strings_size = strings.data.size();
+    h.strings = append(rv, strings.data.data(), strings.data.size());
+    h.size = rv.size();
+
+    memcpy(rv.data(), &h, sizeof(header_t));
+
+    return rv;
+}
+
+void
+MIDIIndex::add_patch(uint16_t bank_no, int program_no, const info_t& info)
+{
+    auto& bank = entries[bank_no];
+    if (bank.find(program_no) == bank.end()) {
+        bank[program_no].patches.push_back(info);
+    }
+}
+
+void
+MIDIIndex::add_ensemble(uint16_t bank_no, int program_no,
+                        const std::string& name, const std::string& file)
+{
+    auto& bank = entries[bank_no];
+    if (bank.find(program_no) == bank.end())
+    {
+        entry_t& entry = bank[program_no];
+        entry.patches.resize(1);
+        entry.patches[0].name = name;
+        entry.patches[0].file = file;
+        entry.patches[0].ensemble = true;
+        entry.include = true;
+    }
+}
+
+std::vector<uint16_t>
+MIDIIndex::get_banks()
+{
+    std::vector<uint16_t> rv;
+    if (data)
+    {
+        const header_t *h = reinterpret_cast<const header_t*>(data);
+        auto banks = reinterpret_cast<const bank_t*>(data+h->banks);
+        for (uint32_t b=0; b<h->no_banks; ++b) {
+            rv.push_back(banks[b].bank_no);
+        }
+    }
+    return rv;
+}
+
+bool
+MIDIIndex::get(uint16_t bank_no, int program_no, ensemble_map_t& rv,
+               bool& include)
+{
+    if (!data) return false;
+
+    uint32_t key = uint32_t(bank_no) << 16 | (program_no & 0xFFFF);
+    if (!requested.insert(key).second) return false;
+
+    const header_t *h = reinterpret_cast<const header_t*>(data);
+    auto banks = reinterpret_cast<const bank_t*>(data+h->banks);
+    auto programs = reinterpret_cast<const program_t*>(data+h->programs);
+    auto patches = reinterpret_cast<const patch_t*>(data+h->patches);
+    const char *strings = reinterpret_cast<const char*>(data+h->strings);
+    auto str = [&](uint32_t offs) -> const char* {
+        return (offs < h->strings_size) ? strings+offs : "";
+    };
+
+    auto b = std::lower_bound(banks, banks+h->no_banks, bank_no,
+                   [](const bank_t& b, uint16_t n) { return b.bank_no < n; });
+    if (b == banks+h->no_banks || b->bank_no != bank_no) return false;
+
+    auto first = programs+b->first;
+    auto last = first+b->count;
+    auto p = std::lower_bound(first, last, program_no,
+             [](const program_t& p, int n) { return p.program_no < n; });
+    if (p == last || p->program_no != program_no) return false;
+
+    rv.clear();
+    rv.reserve(p->count);
+    include = false;
+    for (uint32_t i=p->first; i<p->first+p->count; ++i)
+    {
+        const patch_t& patch = patches[i];
+        info_t info;
+        info.name = str(patch.name);
+        info.file = str(patch.file);
+        info.key_on = str(patch.key_on);
+        info.key_off = str(patch.key_off);
+        info.gain = patch.gain;
+        info.pitch = patch.pitch;
+        info.velocity_fraction = patch.velocity_fraction;
+        info.pan = patch.pan;
+        info.spread = patch.spread;
+        info.wide = patch.wide;
+        info.count = patch.count;
+        info.min_note = patch.min_note;
+        info.max_note = patch.max_note;
+        info.stereo = patch.stereo;
+        info.ensemble = patch.ensemble;
+        info.exclusive = patch.exclusive;
+        include = patch.include;
+        rv.push_back(std::move(info));
+    }
+
+    return true;
+}
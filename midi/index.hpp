@@ -0,0 +1,152 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave MIDI library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include <map>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <filesystem>
+
+namespace aeonwave
+{
+
+#define MIDI_INDEX_MAGIC		"AAXMIDX"
+#define MIDI_INDEX_VERSION		3
+
+struct info_t
+{
+    info_t() = default;
+    ~info_t() = default;
+
+    std::string name;
+    std::string file;
+    std::string key_on;
+    std::string key_off;
+
+    float gain = 1.0f;
+    float pitch = 1.0f;
+    float velocity_fraction = 1.0f;
+
+    float pan = 0.0f;
+    float spread = 1.0f;
+    int wide = 0;
+
+    int count = 1;
+    int min_note = 0;
+    int max_note = 128;
+
+    bool stereo = false;
+    bool ensemble = false;
+
+    int exclusive = 0; // drums only, 0 if the key has no exclusive class
+};
+
+/*
+ * The bank and program catalogue of one instrument or drum XML file.
+ *
+ * Parsing the XML files is slow, so the catalogue is stored as a compact
+ * binary file with flat bank, program and patch tables and one table of
+ * interned strings. The binary file is memory mapped on the next start.
+ * It is stored next to the XML file, or in the user cache directory if
+ * that location is read-only, and it is rebuilt as soon as the XML file
+ * changes.
+ *
+ * Programs are only turned into patch lists when they are requested,
+ * and ensembles only refer to their include file until then, so the
+ * work done at playback time depends on the song and not on the size
+ * of the patch set.
+ */
+class MIDIIndex
+{
+public:
+    using ensemble_map_t = std::vector<info_t>;
+    using program_map_t = std::map<int, ensemble_map_t>;
+    using bank_map_t = std::map<uint16_t, program_map_t>;
+
+    MIDIIndex(const std::filesystem::path& xml, const std::string& type)
+        : source(xml), type(type) {}
+
+    ~MIDIIndex() { close(); }
+
+    MIDIIndex(const MIDIIndex&) = delete;
+    MIDIIndex(MIDIIndex&&) = delete;
+
+    MIDIIndex& operator=(const MIDIIndex&) = delete;
+    MIDIIndex& operator=(MIDIIndex&&) = delete;
+
+    // Returns false if there is no cache or if it is out of date.
+    bool load();
+
+    // Turns the parsed programs into the binary image and tries to store it.
+    bool save();
+
+    // used while parsing the XML file, the first program added wins
+    void add_bank(uint16_t bank_no) { entries[bank_no]; }
+    void add_patch(uint16_t bank_no, int program_no, const info_t& info);
+    void add_ensemble(uint16_t bank_no, int program_no,
+                      const std::string& name, const std::string& file);
+
+    std::vector<uint16_t> get_banks();
+
+    /*
+     * Every program is handed out only once, after that the caller keeps
+     * it. For an ensemble include is set and patches holds one entry
+     * with the program name and the name of the ensemble file.
+     */
+    bool get(uint16_t bank_no, int program_no, ensemble_map_t& patches,
+             bool& include);
+
+    // settings from the aeonwave and set nodes, 0, -1 or empty if not set
+    int refresh_rate = 0;
+    int polyphony = 0;
+    int drum_set_no = -1;
+    int instrument_mode = -1;
+    std::string patch_set;
+    std::string patch_version;
+    std::string effects;
+    bool has_effects = false;
+
+    // bank names and their audio-frame filter and effects file
+    program_map_t configurations;
+
+private:
+    struct entry_t
+    {
+        ensemble_map_t patches;
+        bool include = false;
+    };
+
+    bool load(const std::filesystem::path& cache);
+    bool save(const std::filesystem::path& cache);
+    void close();
+
+    bool read(const uint8_t *data, size_t size);
+    std::vector<uint8_t> write();
+
+    std::filesystem::path cache_file(bool local);
+
+    std::filesystem::path source;
+    std::string type;
+
+    std::map<uint16_t, std::map<int, entry_t>> entries;
+    std::unordered_set<uint32_t> requested;
+
+    // the binary image, mapped or in memory
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    void *mapped = nullptr;
+    std::vector<uint8_t> image;
+};
+
+} // namespace aeonwave
+
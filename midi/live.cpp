@@ -0,0 +1,442 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave MIDI library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstring>
+#include <cerrno>
+
+#ifndef WIN32
+# include <unistd.h>
+# include <fcntl.h>
+# include <poll.h>
+# include <sys/stat.h>
+# include <sys/socket.h>
+# include <sys/un.h>
+# include <netinet/in.h>
+# include <arpa/inet.h>
+#endif
+
+#include <midi/stream.hpp>
+#include <midi/live.hpp>
+
+using namespace aax;
+using policy_t = MIDIPolicyRuntime;
+
+MIDILive::MIDILive(const char *devname, const char *name,
+                   const char *selection, enum aaxRenderMode mode,
+                   const char *config)
+    : MIDIDriver(devname, selection, mode), input(name ? name : "-")
+{
+    if (config)
+    {
+        static const char *prefix = "gmmidi-";
+        static const char *ext = ".xml";
+        gmmidi = config;
+
+        if (gmmidi.compare(0, strlen(prefix), prefix)) {
+            gmmidi.insert(0, prefix);
+        }
+        if (gmmidi.compare(gmmidi.length()-strlen(ext), strlen(ext), ext)) {
+            gmmidi.append(ext);
+        }
+    }
+
+    for (auto& it : latency) {
+        it.store(0, std::memory_order_relaxed);
+    }
+
+    // there is no tempo for live input, one part equals one microsecond
+    midi.set_uspp(1);
+
+    // the message buffer is assigned just before processing each message
+    buffer_map<uint8_t> map(msg.data, 0);
+    byte_stream bs(map);
+    stream = std::shared_ptr<MIDIStream>(new MIDIStream(*this, bs, 0));
+
+    open_input();
+}
+
+MIDILive::~MIDILive()
+{
+    if (running) {
+        running = false;
+        thread.join();
+    }
+    close_input();
+}
+
+void
+MIDILive::open_input()
+{
+#ifndef WIN32
+    if (input == "-" || input == "stdin") {
+        fd = STDIN_FILENO;
+    }
+    else if (!input.compare(0, 4, "udp:"))
+    {
+        std::string host = "127.0.0.1";
+        std::string port = input.substr(4);
+        size_t pos = port.rfind(':');
+        if (pos != std::string::npos)
+        {
+            host = port.substr(0, pos);
+            port = port.substr(pos+1);
+        }
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(atoi(port.c_str()));
+        if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+            throw(std::invalid_argument("Invalid address: "+host));
+        }
+
+        is_socket = true;
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0 || bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+            throw(std::runtime_error("Unable to open: "+input+": "+strerror(errno)));
+        }
+    }
+    else if (!input.compare(0, 5, "unix:"))
+    {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+
+        socket_path = input.substr(5);
+        if (socket_path.size() >= sizeof(addr.sun_path)) {
+            throw(std::invalid_argument("Socket path too long: "+socket_path));
+        }
+        strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path)-1);
+        unlink(socket_path.c_str());
+
+        is_socket = true;
+        fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+        if (fd < 0 || bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+            throw(std::runtime_error("Unable to open: "+input+": "+strerror(errno)));
+        }
+    }
+    else
+    {
+        struct stat st;
+        if (stat(input.c_str(), &st) < 0) {
+            throw(std::invalid_argument("File not found: "+input));
+        }
+
+        // open a FIFO read-write so it never reports end-of-file when
+        // the writing process closes its side
+        int flags = S_ISFIFO(st.st_mode) ? O_RDWR : O_RDONLY;
+        fd = open(input.c_str(), flags|O_NONBLOCK);
+        if (fd < 0) {
+            throw(std::runtime_error("Unable to open: "+input+": "+strerror(errno)));
+        }
+    }
+#else
+    throw(std::runtime_error("Live MIDI input is not supported on this platform"));
+#endif
+}
+
+void
+MIDILive::close_input()
+{
+#ifndef WIN32
+    if (fd > STDIN_FILENO) close(fd);
+    if (!socket_path.empty()) unlink(socket_path.c_str());
+#endif
+    fd = -1;
+}
+
+void
+MIDILive::initialize()
+{
+    // Read the overlay instruments
+    if (!gmmidi.empty()) {
+       midi.read_instruments(gmmidi);
+    }
+
+    // Read the default instruments
+    midi.set_initialize(true);
+    midi.read_instruments();
+    midi.set_initialize(false);
+
+    midi.set(AAX_INITIALIZED);
+    if (midi.get_effects().length())
+    {
+        Buffer &buffer = midi.buffer(midi.get_effects());
+        Sensor::add(buffer);
+    }
+
+    MESSAGE(1, "Frequency : %li Hz\n", midi.get(AAX_FREQUENCY));
+    MESSAGE(1, "Upd. rate : %li Hz\n", midi.get(AAX_REFRESH_RATE));
+    MESSAGE(1, "Patch set : %s", midi.get_patch_set().c_str());
+    MESSAGE(1, " instrument set version %s\n", midi.get_patch_version().c_str());
+    MESSAGE(1, "Input     : %s\n", input.c_str());
+}
+
+void
+MIDILive::start()
+{
+    if (midi.get_verbose()) MIDILog::instance().open();
+    midi.start();
+
+    running = true;
+    thread = std::thread(&MIDILive::reader, this);
+}
+
+void
+MIDILive::stop()
+{
+    if (running)
+    {
+        running = false;
+        thread.join();
+    }
+    midi.stop();
+    MIDILog::instance().close();
+}
+
+// Reader thread: block on the input and parse the bytes as they arrive.
+void
+MIDILive::reader()
+{
+#ifndef WIN32
+    uint8_t buf[256];
+    struct pollfd pfd;
+
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    while (running)
+    {
+        // the timeout only serves to notice a stop request
+        int res = poll(&pfd, 1, 100);
+        if (res <= 0) continue;
+
+        ssize_t len = read(fd, buf, sizeof(buf));
+        clock::time_point now = clock::now();
+        if (len > 0)
+        {
+            for (ssize_t i=0; i<len; ++i) {
+                parse(buf[i], now);
+            }
+        }
+        else if ((len == 0 && !is_socket) ||
+                 (len < 0 && errno != EAGAIN && errno != EINTR))
+        {
+            eof = true;
+            break;
+        }
+    }
+#endif
+}
+
+void
+MIDILive::push(message_t& m, clock::time_point& now)
+{
+    m.timestamp = now;
+    if (!messages.push(m)) {
+        no_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// MIDI 1.0 byte stream parser, returns complete messages to the ring.
+void
+MIDILive::parse(uint8_t byte, clock::time_point& now)
+{
+    if (byte >= 0xf8) // real-time messages may appear anywhere
+    {
+        // only a system reset is of interest, timing clock, start,
+        // continue, stop and active sensing are ignored
+        if (byte == 0xff)
+        {
+            message_t reset;
+            reset.data[0] = byte;
+            reset.size = 1;
+            push(reset, now);
+        }
+        return;
+    }
+
+    if (byte & 0x80) // status byte
+    {
+        if (sysex)
+        {
+            sysex = false;
+            if (byte == MIDI_SYSTEM_EXCLUSIVE_END)
+            {
+                // convert to the file format: F0 <length> <data> F7
+                if (sysex_size < sysex_data.size())
+                {
+                    sysex_data[sysex_size++] = byte;
+                    msg.data[0] = MIDI_SYSTEM_EXCLUSIVE;
+                    msg.data[1] = sysex_size;
+                    memcpy(msg.data+2, sysex_data.data(), sysex_size);
+                    msg.size = sysex_size+2;
+                    push(msg, now);
+                }
+                else {
+                    no_dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+                return;
+            }
+            // an unterminated system exclusive message gets discarded
+            no_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        msg.size = 0;
+        switch(byte)
+        {
+        case MIDI_SYSTEM_EXCLUSIVE:
+            running_status = 0;
+            sysex_size = 0;
+            sysex = true;
+            break;
+        case MIDI_SYSTEM_EXCLUSIVE_END: // stray end of exclusive
+            break;
+        case MIDI_SYSTEM|MIDI_TIMING_CODE:
+        case MIDI_SYSTEM|MIDI_SONG_SELECT:
+            running_status = 0;
+            msg.data[msg.size++] = byte;
+            expected = 2;
+            break;
+        case MIDI_SYSTEM|MIDI_POSITION_POINTER:
+            running_status = 0;
+            msg.data[msg.size++] = byte;
+            expected = 3;
+            break;
+        default:
+            if (byte >= MIDI_SYSTEM) // tune request and undefined messages
+            {
+                running_status = 0;
+                msg.data[msg.size++] = byte;
+                push(msg, now);
+                msg.size = 0;
+            }
+            else
+            {
+                switch(byte & 0xf0)
+                {
+                case MIDI_PROGRAM_CHANGE:
+                case MIDI_CHANNEL_AFTERTOUCH:
+                    expected = 2;
+                    break;
+                default:
+                    expected = 3;
+                    break;
+                }
+                running_status = byte;
+                msg.data[msg.size++] = byte;
+            }
+            break;
+        }
+        return;
+    }
+
+    // data byte
+    if (sysex)
+    {
+        // keep one byte for the end of exclusive
+        if (sysex_size < sysex_data.size()-1) {
+            sysex_data[sysex_size++] = byte;
+        } else {
+            sysex_size = sysex_data.size();
+        }
+        return;
+    }
+
+    if (msg.size == 0)
+    {
+        if (!running_status) return; // orphaned data byte
+        msg.data[msg.size++] = running_status;
+    }
+
+    msg.data[msg.size++] = byte;
+    if (msg.size == expected)
+    {
+        push(msg, now);
+        msg.size = 0;
+    }
+}
+
+bool
+MIDILive::process(uint64_t time_parts, uint32_t& next)
+{
+    stats_process_scope scope(midi.stats());
+    trace_scope trace("process", "sequencer");
+    message_t *m;
+
+    midi.update_voices();
+
+    while ((m = messages.front()) != nullptr)
+    {
+        auto dt = clock::now() - m->timestamp;
+        uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(dt).count();
+        size_t n = 0;
+        while (us >>= 1) ++n;
+        n = _MIN(n, latency.size()-1);
+        latency[n].fetch_add(1, std::memory_order_relaxed);
+        no_messages.fetch_add(1, std::memory_order_relaxed);
+
+        try
+        {
+            if (m->data[0] == 0xff) // system reset
+            {
+                // all notes off and reset all controllers, every channel
+                for (auto& it : midi.get_channels())
+                {
+                    MIDIEnsemble& channel = *it.second;
+                    channel.set_hold(false);
+                    channel.set_sustain(false);
+                    midi.all_notes_off(it.first);
+                    channel.reset_controllers();
+                    midi.get_params(it.first).reset();
+                }
+            }
+            else {
+                stream->process(m->data, m->size);
+            }
+        } catch (const std::exception &e) {
+            ERROR("Error while processing live MIDI input: " << e.what());
+        }
+        messages.pop();
+    }
+
+    // poll once per mixer frame, nothing can be heard any sooner
+    int64_t refresh_rate = midi.get(AAX_REFRESH_RATE);
+    next = _MAX(1000000/_MAX(refresh_rate, 1), 1);
+
+    return !(eof && messages.empty());
+}
+
+std::array<uint32_t, MIDI_LIVE_LATENCY_BUCKETS>
+MIDILive::get_latency_histogram()
+{
+    std::array<uint32_t, MIDI_LIVE_LATENCY_BUCKETS> rv;
+    for (size_t i=0; i<rv.size(); ++i) {
+        rv[i] = latency[i].load(std::memory_order_relaxed);
+    }
+    return rv;
+}
+
+void
+MIDILive::print_latency_histogram()
+{
+    auto histogram = get_latency_histogram();
+
+    MESSAGE(1, "\nMessages  : %lu, dropped: %u\n",
+            (unsigned long)get_no_messages(), get_no_dropped());
+    MESSAGE(1, "Latency from arrival to dispatch:\n");
+    for (size_t i=0; i<histogram.size(); ++i)
+    {
+        if (!histogram[i]) continue;
+        MESSAGE(1, "  < %9lu us: %u\n", 2UL << i, histogram[i]);
+    }
+}
@@ -0,0 +1,107 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave MIDI library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <array>
+
+#include <aax/byte_stream.hpp>
+
+#include <midi/shared.hpp>
+#include <midi/driver.hpp>
+#include <midi/ring_buffer.hpp>
+
+namespace aeonwave
+{
+
+#define MIDI_LIVE_MAX_MESSAGE_SIZE	128
+
+class MIDIStream;
+
+/*
+ * Plays raw MIDI 1.0 bytes as they arrive from stdin, a FIFO, a file or a
+ * local socket. The input name selects the source:
+ *   "-" or "stdin"         standard input
+ *   "udp:[host:]port"      UDP socket, host defaults to 127.0.0.1
+ *   "unix:path"            UNIX datagram socket
+ *   anything else          a FIFO or file path
+ *
+ * A reader thread parses the bytes (running status, system exclusive and
+ * interleaved real-time bytes), timestamps every complete message on
+ * arrival and hands it to the sequencer thread through a lock-free ring.
+ */
+class MIDILive : public MIDIDriver
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct message_t
+    {
+        clock::time_point timestamp;
+        uint16_t size = 0;
+        uint8_t data[MIDI_LIVE_MAX_MESSAGE_SIZE];
+    };
+
+    MIDILive(const char *devname, const char *input, const char *track=nullptr, enum aaxRenderMode mode=AAX_MODE_WRITE_STEREO, const char *config=nullptr);
+
+    virtual ~MIDILive();
+
+    void initialize();
+    void start();
+    void stop();
+
+    // dispatch all pending messages, next is the poll interval in parts
+    bool process(uint64_t, uint32_t&);
+
+    // bucket n counts the messages with an arrival to dispatch latency
+    // between 2^n and 2^(n+1) microseconds
+    std::array<uint32_t, MIDI_LIVE_LATENCY_BUCKETS> get_latency_histogram();
+    void print_latency_histogram();
+
+    uint64_t get_no_messages() { return no_messages; }
+    uint32_t get_no_dropped() { return no_dropped; }
+
+private:
+    void open_input();
+    void close_input();
+    void reader();
+    void parse(uint8_t byte, clock::time_point& now);
+    void push(message_t& m, clock::time_point& now);
+
+    std::string input;
+    std::string gmmidi;
+    std::string socket_path;
+    int fd = -1;
+    bool is_socket = false;
+
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<bool> eof{false};
+
+    ring_buffer<message_t, 256> messages;
+    std::shared_ptr<MIDIStream> stream;
+
+    // reader thread parser state
+    message_t msg;
+    uint8_t running_status = 0;
+    uint8_t expected = 0;
+    bool sysex = false;
+    std::array<uint8_t, MIDI_LIVE_MAX_MESSAGE_SIZE-2> sysex_data;
+    size_t sysex_size = 0;
+
+    std::array<std::atomic<uint32_t>, MIDI_LIVE_LATENCY_BUCKETS> latency;
+    std::atomic<uint64_t> no_messages{0};
+    std::atomic<uint32_t> no_dropped{0};
+};
+
+} // namespace aeonwave
+
@@ -0,0 +1,137 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave MIDI library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#if defined(__linux__)
+# include <pthread.h>
+# include <sched.h>
+#endif
+
+#include <algorithm>
+
+#include <midi/log.hpp>
+
+using namespace aeonwave;
+
+// The last byte of the text buffer always holds the terminating zero,
+// a string which does not fit anymore points to it.
+uint16_t
+log_arg<const char*>::store(const char *s, log_entry_t& e)
+{
+    uint16_t rv = e.text_len;
+    if (!s) s = "(null)";
+
+    size_t len = strnlen(s, MIDI_LOG_TEXT_SIZE-1 - rv);
+    memcpy(e.text + rv, s, len);
+    e.text[rv + len] = 0;
+    e.text_len = std::min<size_t>(rv + len + 1, MIDI_LOG_TEXT_SIZE-1);
+
+    return rv;
+}
+
+MIDILog&
+MIDILog::instance()
+{
+    static MIDILog log;
+    return log;
+}
+
+bool
+MIDILog::open(FILE *f)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (fp || !f) return false;
+
+    fp = f;
+    next_status = clock::now();
+    status_line.clear();
+
+    active = true;
+    thread = std::thread(&MIDILog::writer, this);
+
+#if defined(__linux__)
+    // only run when nothing else wants the cpu
+    struct sched_param param = {};
+    pthread_setschedparam(thread.native_handle(), SCHED_IDLE, &param);
+#endif
+
+    return true;
+}
+
+void
+MIDILog::close()
+{
+    if (!active) return;
+
+    active = false;
+    thread.join();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    drain();
+    fp = nullptr;
+}
+
+// Every thread registers its ring the first time it logs a message,
+// the ring stays registered after the thread exits so nothing is lost.
+MIDILog::ring_t&
+MIDILog::local()
+{
+    thread_local std::shared_ptr<ring_t> ring;
+    if (!ring)
+    {
+        ring = std::make_shared<ring_t>();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        rings.push_back(ring);
+    }
+    return *ring;
+}
+
+bool
+MIDILog::status_due()
+{
+    clock::time_point now = clock::now();
+    if (now < next_status) return false;
+
+    next_status = now + std::chrono::milliseconds(MIDI_LOG_REFRESH_MS);
+    return true;
+}
+
+void
+MIDILog::writer()
+{
+    while (active)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(MIDI_LOG_REFRESH_MS));
+
+        std::lock_guard<std::mutex> lock(mutex);
+        drain();
+    }
+}
+
+// Called with the mutex locked. Messages go first, the status line is
+// printed last so it stays at the bottom of the terminal.
+void
+MIDILog::drain()
+{
+    log_entry_t *e;
+    for (auto& it : rings)
+    {
+        while ((e = it->front()) != nullptr)
+        {
+            e->print(fp, *e);
+            it->pop();
+        }
+    }
+
+    log_entry_t *latest = status_line.fetch();
+    if (latest) latest->print(fp, *latest);
+
+    fflush(fp);
+}
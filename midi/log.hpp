@@ -0,0 +1,232 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave MIDI library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <type_traits>
+
+#include <midi/ring_buffer.hpp>
+
+namespace aeonwave
+{
+
+#define MIDI_LOG_ARGS_SIZE		64
+#define MIDI_LOG_TEXT_SIZE		256
+#define MIDI_LOG_REFRESH_MS		50
+
+struct log_entry_t
+{
+    void (*print)(FILE*, const log_entry_t&);
+    const char *fmt;
+    alignas(8) uint8_t args[MIDI_LOG_ARGS_SIZE];
+    uint16_t text_len;
+    char text[MIDI_LOG_TEXT_SIZE];
+};
+
+// How an argument is stored in a log entry. Strings are copied into the
+// text buffer of the entry, they might be gone by the time it is printed.
+template<typename T>
+struct log_arg
+{
+    static_assert(std::is_trivially_copyable_v<T>, "unsupported log argument");
+
+    using type = T;
+    static inline T store(T v, log_entry_t&) { return v; }
+    static inline T load(T v, const log_entry_t&) { return v; }
+};
+
+template<>
+struct log_arg<const char*>
+{
+    using type = uint16_t;
+    static uint16_t store(const char *s, log_entry_t& e);
+    static inline const char* load(uint16_t offs, const log_entry_t& e) {
+        return e.text + offs;
+    }
+};
+
+template<>
+struct log_arg<char*> : public log_arg<const char*> {};
+
+/*
+ * Prints the verbose output of the sequencer from a low priority thread.
+ *
+ * The sequencer only stores the format string, which must be a string
+ * literal and serves as the message id, and the raw arguments in a
+ * lock-free ring buffer of the recording thread. Formatting and writing
+ * happen in the writer thread, a slow terminal or a redirected log can
+ * not stall playback. Messages which do not fit in the ring are counted
+ * as dropped, strings longer than the text buffer are truncated.
+ *
+ * The status line is kept apart: only its latest state gets printed,
+ * at a fixed rate which does not depend on the number of events.
+ *
+ * When the writer thread is not running everything is printed directly.
+ */
+class MIDILog
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    static MIDILog& instance();
+
+    ~MIDILog() { close(); }
+
+    bool open(FILE *fp = stdout);
+    void close();
+
+    static inline bool enabled() {
+        return instance().active.load(std::memory_order_relaxed);
+    }
+
+    template<typename... Args>
+    void message(const char *fmt, Args... args)
+    {
+        if (!enabled()) {
+            print_now(fmt, args...);
+            return;
+        }
+
+        log_entry_t e;
+        pack<Args...>(e, fmt, args...);
+        if (!local().push(e)) {
+            no_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Returns true if the status line may be updated again, this saves
+    // the caller from formatting status lines which will never be shown.
+    bool status_due();
+
+    template<typename... Args>
+    void status(const char *fmt, Args... args)
+    {
+        if (!enabled()) {
+            print_now(fmt, args...);
+            fflush(stdout);
+            return;
+        }
+
+        pack<Args...>(status_line.back(), fmt, args...);
+        status_line.publish();
+    }
+
+    // The writer thread flushes its output after every pass.
+    void flush() {
+        if (!enabled()) fflush(stdout);
+    }
+
+    uint32_t get_no_dropped() { return no_dropped; }
+
+private:
+    MIDILog() = default;
+
+    using ring_t = ring_buffer<log_entry_t, 512>;
+
+    template<typename... T>
+    static constexpr std::array<size_t, sizeof...(T)> offsets()
+    {
+        std::array<size_t, sizeof...(T)> rv{};
+        size_t offs = 0, i = 0;
+        ((offs = (offs + alignof(T)-1) & ~(alignof(T)-1),
+          rv[i++] = offs, offs += sizeof(T)), ...);
+        return rv;
+    }
+
+    template<typename... T>
+    static constexpr size_t args_size()
+    {
+        size_t offs = 0;
+        ((offs = ((offs + alignof(T)-1) & ~(alignof(T)-1)) + sizeof(T)), ...);
+        return offs;
+    }
+
+    template<typename... Args>
+    static void pack(log_entry_t& e, const char *fmt, Args... args)
+    {
+        static_assert(args_size<typename log_arg<Args>::type...>() <= MIDI_LOG_ARGS_SIZE,
+                      "too many log arguments");
+
+        e.print = &print<Args...>;
+        e.fmt = fmt;
+        e.text_len = 0;
+        store<Args...>(e, std::index_sequence_for<Args...>{}, args...);
+    }
+
+    template<typename... Args, size_t... I>
+    static void store(log_entry_t& e, std::index_sequence<I...>, Args... args)
+    {
+        [[maybe_unused]] constexpr auto offs = offsets<typename log_arg<Args>::type...>();
+        (put(e, offs[I], log_arg<Args>::store(args, e)), ...);
+    }
+
+    template<typename... Args>
+    static void print(FILE *fp, const log_entry_t& e) {
+        load<Args...>(fp, e, std::index_sequence_for<Args...>{});
+    }
+
+    template<typename... Args, size_t... I>
+    static void load(FILE *fp, const log_entry_t& e, std::index_sequence<I...>)
+    {
+        if constexpr (sizeof...(Args) == 0) {
+            fputs(e.fmt, fp);
+        } else {
+            constexpr auto offs = offsets<typename log_arg<Args>::type...>();
+            fprintf(fp, e.fmt, log_arg<Args>::load(
+                         get<typename log_arg<Args>::type>(e, offs[I]), e)...);
+        }
+    }
+
+    template<typename T>
+    static inline void put(log_entry_t& e, size_t offs, T v) {
+        memcpy(e.args + offs, &v, sizeof(T));
+    }
+
+    template<typename T>
+    static inline T get(const log_entry_t& e, size_t offs) {
+        T rv;
+        memcpy(&rv, e.args + offs, sizeof(T));
+        return rv;
+    }
+
+    template<typename... Args>
+    static void print_now(const char *fmt, Args... args) {
+        if constexpr (sizeof...(Args) == 0) fputs(fmt, stdout);
+        else printf(fmt, args...);
+    }
+
+    ring_t& local();
+    void writer();
+    void drain();
+
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ring_t>> rings;
+    latest_buffer<log_entry_t> status_line;
+    std::thread thread;
+    std::atomic<bool> active{false};
+    std::atomic<uint32_t> no_dropped{0};
+
+    FILE *fp = nullptr;
+    clock::time_point next_status;
+};
+
+} // namespace aeonwave
+
@@ -22,6 +22,9 @@
 
 #include <aax/midi.h>
 #include <midi/file.hpp>
+#include <midi/live.hpp>
+#include <midi/export.hpp>
+#include <midi/trace.hpp>
 
 using namespace aax;
 
@@ -161,6 +164,147 @@ MIDI::set_csv(char v)
     file->set_csv(v);
 }
 
+void
+MIDI::set_lookahead(float sec)
+{
+    file->set_lookahead(sec);
+}
+
+void
+MIDI::set_timeline(bool t)
+{
+    file->set_timeline(t);
+}
+
+bool
+MIDI::post_pause()
+{
+    return file->post_pause();
+}
+
+bool
+MIDI::post_resume()
+{
+    return file->post_resume();
+}
+
+bool
+MIDI::post_seek(float pos_sec)
+{
+    return file->post_seek(pos_sec);
+}
+
+bool
+MIDI::post_volume(float g)
+{
+    return file->post_volume(100.0f*g/127.0f);
+}
+
+bool
+MIDI::post_track_mute(uint16_t track, bool mute)
+{
+    return file->post_track_mute(track, mute);
+}
+
+bool
+MIDI::post_track_solo(int32_t track)
+{
+    return file->post_track_solo(track);
+}
+
+bool
+MIDI::post_tempo_scale(float s)
+{
+    return file->post_tempo_scale(s);
+}
+
+bool
+MIDI::get_stats(aaxMIDIStats& s)
+{
+    file->get_stats(s);
+    return true;
+}
+
+MIDIInput::MIDIInput(const char *devname, const char *input,
+                     const char *selection, enum aaxRenderMode mode,
+                     const char *config)
+   : live(new MIDILive(devname, input, selection, mode, config))
+{
+}
+
+MIDIInput::~MIDIInput()
+{
+}
+
+void
+MIDIInput::initialize()
+{
+    live->initialize();
+}
+
+void
+MIDIInput::start()
+{
+    live->start();
+}
+
+void
+MIDIInput::stop()
+{
+    live->stop();
+}
+
+bool
+MIDIInput::process(uint64_t time_parts, uint32_t& next)
+{
+    return live->process(time_parts, next);
+}
+
+int32_t
+MIDIInput::get_uspp()
+{
+    return live->get_uspp();
+}
+
+void
+MIDIInput::set_volume(float g)
+{
+    live->set_volume(100.0f*g/127.0f);
+}
+
+void
+MIDIInput::set_mono(bool m)
+{
+    live->set_mono(m);
+}
+
+void
+MIDIInput::set_verbose(char v)
+{
+    live->set_verbose(v);
+}
+
+bool
+MIDIInput::get_stats(aaxMIDIStats& s)
+{
+    live->get_stats(s);
+    return true;
+}
+
+bool
+MIDIInput::get_latency(uint32_t buckets[MIDI_LIVE_LATENCY_BUCKETS])
+{
+    auto histogram = live->get_latency_histogram();
+    std::copy(histogram.begin(), histogram.end(), buckets);
+    return true;
+}
+
+void
+MIDIInput::print_latency_histogram()
+{
+    live->print_latency_histogram();
+}
+
 // -----------------------------------------------------------------------
 // C API
 // -----------------------------------------------------------------------
@@ -287,4 +431,198 @@ aaxMIDISetVerbose(aaxMIDI *handle, char v)
 void
 aaxMIDISetCSV(aaxMIDI *handle, char v)
 {
+    reinterpret_cast<MIDI*>(handle)->set_csv(v);
+}
+
+int
+aaxMIDIPause(aaxMIDI *handle)
+{
+    return reinterpret_cast<MIDI*>(handle)->post_pause();
+}
+
+int
+aaxMIDIResume(aaxMIDI *handle)
+{
+    return reinterpret_cast<MIDI*>(handle)->post_resume();
+}
+
+int
+aaxMIDISeek(aaxMIDI *handle, float pos_sec)
+{
+    return reinterpret_cast<MIDI*>(handle)->post_seek(pos_sec);
+}
+
+int
+aaxMIDISetVolume(aaxMIDI *handle, float g)
+{
+    return reinterpret_cast<MIDI*>(handle)->post_volume(g);
+}
+
+int
+aaxMIDISetTrackMute(aaxMIDI *handle, int track, int mute)
+{
+    return reinterpret_cast<MIDI*>(handle)->post_track_mute(track, mute);
+}
+
+int
+aaxMIDISetTrackSolo(aaxMIDI *handle, int track)
+{
+    return reinterpret_cast<MIDI*>(handle)->post_track_solo(track);
+}
+
+int
+aaxMIDISetTempoScale(aaxMIDI *handle, float s)
+{
+    return reinterpret_cast<MIDI*>(handle)->post_tempo_scale(s);
+}
+
+int
+aaxMIDIGetStats(aaxMIDI *handle, aaxMIDIStats *s)
+{
+    if (!s) return AAX_FALSE;
+    return reinterpret_cast<MIDI*>(handle)->get_stats(*s);
+}
+
+int
+aaxMIDIExport(const char *filename, const char *outfile,
+              enum aaxMIDIExportFormat format)
+{
+    FILE *fp = nullptr;
+    bool rv = false;
+
+    if (!filename) return AAX_FALSE;
+
+    try
+    {
+        MIDIExport midi(filename);
+
+        fp = outfile ? fopen(outfile, "wb") : stdout;
+        if (!fp) return AAX_FALSE;
+
+        midi.write(fp, format);
+        rv = !ferror(fp);
+    } catch (const std::exception&) {
+        rv = false;
+    }
+
+    if (fp && fp != stdout)
+    {
+        rv &= (fclose(fp) == 0);
+
+        // do not leave a truncated file behind
+        if (!rv) remove(outfile);
+    }
+    else if (fp) {
+        fflush(fp);
+    }
+
+    return rv;
+}
+
+int
+aaxMIDITraceOpen(const char *filename)
+{
+    if (!filename) return AAX_FALSE;
+    return MIDITrace::instance().open(filename);
+}
+
+void
+aaxMIDITraceClose()
+{
+    MIDITrace::instance().close();
+}
+
+MIDITraceSleep::MIDITraceSleep(float requested_sec)
+    : enabled(MIDITrace::enabled())
+{
+    if (enabled)
+    {
+        start = MIDITrace::clock::now();
+        requested_us = int64_t(requested_sec*1e6f);
+    }
+}
+
+MIDITraceSleep::~MIDITraceSleep()
+{
+    if (enabled) {
+        MIDITrace::instance().span("sleep", "scheduler", start, -1,
+                                   "requested_us", requested_us);
+    }
+}
+
+aaxMIDIInput*
+aaxMIDIInputCreate(const char *devname, const char *input, const char *track, enum aaxRenderMode mode, const char *config)
+{
+    return reinterpret_cast<aaxMIDIInput*>(new MIDIInput(devname, input, track, mode, config));
+}
+
+void
+aaxMIDIInputDestroy(aaxMIDIInput *handle)
+{
+    delete reinterpret_cast<MIDIInput*>(handle);
+}
+
+void
+aaxMIDIInputInitialize(aaxMIDIInput *handle)
+{
+    reinterpret_cast<MIDIInput*>(handle)->initialize();
+}
+
+void
+aaxMIDIInputStart(aaxMIDIInput *handle)
+{
+    reinterpret_cast<MIDIInput*>(handle)->start();
+}
+
+void
+aaxMIDIInputStop(aaxMIDIInput *handle)
+{
+    reinterpret_cast<MIDIInput*>(handle)->stop();
+}
+
+int
+aaxMIDIInputProcess(aaxMIDIInput *handle, uint64_t time_parts, uint32_t* next)
+{
+    uint32_t ntime = *next;
+    int rv = reinterpret_cast<MIDIInput*>(handle)->process(time_parts, ntime);
+    *next = ntime;
+    return rv;
+}
+
+int32_t
+aaxMIDIInputGetUSPP(aaxMIDIInput *handle)
+{
+    return reinterpret_cast<MIDIInput*>(handle)->get_uspp();
+}
+
+void
+aaxMIDIInputSetVolume(aaxMIDIInput *handle, float g)
+{
+    reinterpret_cast<MIDIInput*>(handle)->set_volume(g);
+}
+
+void
+aaxMIDIInputSetMono(aaxMIDIInput *handle, int m)
+{
+    reinterpret_cast<MIDIInput*>(handle)->set_mono(m);
+}
+
+void
+aaxMIDIInputSetVerbose(aaxMIDIInput *handle, char v)
+{
+    reinterpret_cast<MIDIInput*>(handle)->set_verbose(v);
+}
+
+int
+aaxMIDIInputGetStats(aaxMIDIInput *handle, aaxMIDIStats *s)
+{
+    if (!s) return AAX_FALSE;
+    return reinterpret_cast<MIDIInput*>(handle)->get_stats(*s);
+}
+
+int
+aaxMIDIInputGetLatency(aaxMIDIInput *handle, uint32_t buckets[MIDI_LIVE_LATENCY_BUCKETS])
+{
+    if (!buckets) return AAX_FALSE;
+    return reinterpret_cast<MIDIInput*>(handle)->get_latency(buckets);
 }
@@ -0,0 +1,115 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave MIDI library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include <array>
+
+#include <aax/midi.h>
+
+namespace aeonwave
+{
+
+#define MIDI_NRPN_TABLE_SIZE		64
+
+struct param_t
+{
+   uint8_t coarse;
+   uint8_t fine;
+};
+
+/*
+ * The registered (RPN) and non-registered (NRPN) parameter state of one
+ * MIDI channel.
+ *
+ * Parameter numbers are the MSB shifted left by eight bits or'ed with the
+ * LSB, the same as the parameter numbers in aax/midi.h. Registered
+ * parameters 0x0000 up to and including 0x0006 are indexed directly, the
+ * other registered parameters only trigger an action and keep no value.
+ * Non-registered parameters are kept in a small open addressed table,
+ * once it is full the values of new parameters are not stored anymore.
+ *
+ * The state is plain data, copying it takes a snapshot.
+ */
+class MIDIParams
+{
+public:
+    MIDIParams() { reset(); }
+
+    void reset()
+    {
+        rpn = {{
+            { 2, 0 }, { 0x40, 0 }, { 0x20, 0 }, { 0, 0 }, { 0, 0 }, { 1, 0 },
+            { 0, 0 }
+        }};
+        for (auto& it : nrpn) it.type = NRPN_EMPTY;
+        type = MIDI_NULL_FUNCTION_NUMBER;
+        registered = false;
+    }
+
+    // Select the parameter the data entry controllers apply to.
+    inline void select_coarse(bool reg, uint8_t msb) {
+        registered = reg; type = (type & 0x00ff) | (msb & 0x7f) << 8;
+    }
+    inline void select_fine(bool reg, uint8_t lsb) {
+        registered = reg; type = (type & 0xff00) | (lsb & 0x7f);
+    }
+    inline void deselect() { type = MIDI_NULL_FUNCTION_NUMBER; }
+
+    inline bool selected() const { return type != MIDI_NULL_FUNCTION_NUMBER; }
+    inline bool is_registered() const { return registered; }
+    inline uint16_t get_type() const { return type; }
+
+    // Returns the value of the selected parameter or nullptr if it is not
+    // selected or has no storage.
+    param_t* get()
+    {
+        if (!selected()) return nullptr;
+        if (registered) return (type < rpn.size()) ? &rpn[type] : nullptr;
+
+        size_t i = (type ^ (type >> 6)) & (nrpn.size()-1);
+        for (size_t n=0; n<nrpn.size(); ++n, i = (i+1) & (nrpn.size()-1))
+        {
+            if (nrpn[i].type == type) return &nrpn[i].value;
+            if (nrpn[i].type == NRPN_EMPTY)
+            {
+                nrpn[i].type = type;
+                nrpn[i].value = { 0, 0 };
+                return &nrpn[i].value;
+            }
+        }
+        return nullptr;
+    }
+
+    // type must be a registered parameter with storage, see above.
+    inline const param_t& get_rpn(uint16_t t) const { return rpn[t]; }
+
+private:
+    static constexpr uint16_t NRPN_EMPTY = 0xffff;
+
+    struct nrpn_t
+    {
+        uint16_t type;
+        param_t value;
+    };
+
+    std::array<param_t, MIDI_MPE_CONFIGURATION_MESSAGE+1> rpn;
+    std::array<nrpn_t, MIDI_NRPN_TABLE_SIZE> nrpn;
+    static_assert((MIDI_NRPN_TABLE_SIZE & (MIDI_NRPN_TABLE_SIZE-1)) == 0,
+                  "MIDI_NRPN_TABLE_SIZE must be a power of two");
+
+    uint16_t type;
+    bool registered;
+};
+
+} // namespace aeonwave
+
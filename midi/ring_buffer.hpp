@@ -0,0 +1,234 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave MIDI library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <array>
+#include <vector>
+
+namespace aeonwave
+{
+
+/*
+ * Single producer, single consumer lock-free ring buffer.
+ *
+ * One thread may call push() while another thread calls pop(), neither
+ * of them ever blocks. Size must be a power of two; one slot is kept
+ * empty to tell a full ring from an empty one.
+ */
+template <typename T, size_t Size>
+class ring_buffer
+{
+    static_assert((Size & (Size-1)) == 0, "Size must be a power of two");
+
+public:
+    ring_buffer() = default;
+    ~ring_buffer() = default;
+
+    ring_buffer(const ring_buffer&) = delete;
+    ring_buffer& operator=(const ring_buffer&) = delete;
+
+    // producer side
+    bool push(const T& item) {
+        size_t head = head_idx.load(std::memory_order_relaxed);
+        size_t next = (head + 1) & (Size-1);
+        if (next == tail_idx.load(std::memory_order_acquire)) {
+            return false;
+        }
+        ring[head] = item;
+        head_idx.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side
+    bool pop(T& item) {
+        size_t tail = tail_idx.load(std::memory_order_relaxed);
+        if (tail == head_idx.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = ring[tail];
+        tail_idx.store((tail + 1) & (Size-1), std::memory_order_release);
+        return true;
+    }
+
+    // consumer side, discard the oldest item
+    bool pop() {
+        size_t tail = tail_idx.load(std::memory_order_relaxed);
+        if (tail == head_idx.load(std::memory_order_acquire)) {
+            return false;
+        }
+        tail_idx.store((tail + 1) & (Size-1), std::memory_order_release);
+        return true;
+    }
+
+    // consumer side, only valid until the next pop()
+    T* front() {
+        size_t tail = tail_idx.load(std::memory_order_relaxed);
+        if (tail == head_idx.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &ring[tail];
+    }
+
+    bool empty() const {
+        return head_idx.load(std::memory_order_acquire) ==
+               tail_idx.load(std::memory_order_acquire);
+    }
+
+    size_t size() const {
+        size_t head = head_idx.load(std::memory_order_acquire);
+        size_t tail = tail_idx.load(std::memory_order_acquire);
+        return (head - tail) & (Size-1);
+    }
+
+    static constexpr size_t capacity() { return Size-1; }
+
+    // only safe when neither side is active
+    void clear() {
+        head_idx.store(0, std::memory_order_relaxed);
+        tail_idx.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::array<T,Size> ring;
+
+    // keep the indices on separate cache lines to avoid false sharing
+    alignas(64) std::atomic<size_t> head_idx{0};
+    alignas(64) std::atomic<size_t> tail_idx{0};
+};
+
+/*
+ * Single producer, single consumer slot which only keeps the latest item.
+ *
+ * The producer fills back() and publishes it, which overwrites an item
+ * the consumer did not fetch yet. Three buffers are swapped through one
+ * atomic index so neither side ever blocks or sees a half written item.
+ */
+template <typename T>
+class latest_buffer
+{
+public:
+    latest_buffer() = default;
+    ~latest_buffer() = default;
+
+    latest_buffer(const latest_buffer&) = delete;
+    latest_buffer& operator=(const latest_buffer&) = delete;
+
+    // producer side, the item to fill in before it gets published
+    T& back() { return buffer[back_idx]; }
+
+    void publish() {
+        uint8_t prev = middle_idx.exchange(back_idx | FRESH,
+                                           std::memory_order_acq_rel);
+        back_idx = prev & INDEX;
+    }
+
+    // consumer side, the latest item if it was not fetched before,
+    // only valid until the next fetch()
+    T* fetch() {
+        if (!(middle_idx.load(std::memory_order_relaxed) & FRESH)) {
+            return nullptr;
+        }
+        uint8_t prev = middle_idx.exchange(front_idx,
+                                           std::memory_order_acq_rel);
+        front_idx = prev & INDEX;
+        return &buffer[front_idx];
+    }
+
+    // only safe when neither side is active
+    void clear() {
+        back_idx = 0;
+        middle_idx.store(1, std::memory_order_relaxed);
+        front_idx = 2;
+    }
+
+private:
+    static constexpr uint8_t INDEX = 0x3;
+    static constexpr uint8_t FRESH = 0x4;
+
+    std::array<T,3> buffer;
+
+    // keep the indices on separate cache lines to avoid false sharing
+    alignas(64) uint8_t back_idx = 0;
+    alignas(64) std::atomic<uint8_t> middle_idx{1};
+    alignas(64) uint8_t front_idx = 2;
+};
+
+/*
+ * Single producer, single consumer ring of variable sized byte blocks.
+ *
+ * The producer reserves a block with alloc() and hands its position to
+ * the consumer through another queue, the consumer releases the blocks
+ * in the same order. A block never wraps around the end of the ring so
+ * it is always contiguous, positions only ever increase.
+ */
+class ring_arena
+{
+public:
+    ring_arena() = default;
+    ~ring_arena() = default;
+
+    ring_arena(const ring_arena&) = delete;
+    ring_arena& operator=(const ring_arena&) = delete;
+
+    // producer side, returns true if a block of len bytes fits
+    bool room(size_t len) const {
+        uint64_t tail = tail_pos.load(std::memory_order_acquire);
+        if (tail == head_pos) { // empty, the skipped end is free too
+            return (len <= data.size());
+        }
+        return (start(len) + len - tail <= data.size());
+    }
+
+    // producer side
+    bool alloc(size_t len, uint64_t& pos) {
+        if (!room(len)) return false;
+        pos = start(len);
+        head_pos = pos + len;
+        return true;
+    }
+
+    uint8_t* get(uint64_t pos) { return data.data() + pos % data.size(); }
+
+    // consumer side, release every block up to and including the one
+    // which ends at end
+    void release(uint64_t end) {
+        tail_pos.store(end, std::memory_order_release);
+    }
+
+    size_t capacity() const { return data.size(); }
+
+    // only safe when neither side is active
+    void resize(size_t size) {
+        data.resize(size);
+        clear();
+    }
+    void clear() {
+        head_pos = 0;
+        tail_pos.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    // skip the end of the ring if the block does not fit in there
+    uint64_t start(size_t len) const {
+        size_t offs = head_pos % data.size();
+        return (offs + len > data.size()) ? head_pos+data.size()-offs : head_pos;
+    }
+
+    std::vector<uint8_t> data = std::vector<uint8_t>(1);
+    uint64_t head_pos = 0;
+    alignas(64) std::atomic<uint64_t> tail_pos{0};
+};
+
+} // namespace aeonwave
+
@@ -24,38 +24,105 @@
 
 #include <aax/midi.h>
 
+#include <midi/log.hpp>
+
 namespace aax = aeonwave;
 
-#define DISPLAY(l,...) \
-  if(midi.get_initialize() && l <= midi.get_verbose()) printf(__VA_ARGS__)
-#define MESSAGE(l,...) \
-  if(!midi.get_initialize() && midi.get_verbose() >= l) printf(__VA_ARGS__)
-#define INFO(s) \
-  if(!midi.get_initialize() && midi.get_verbose() >= 1 && !midi.get_lyrics()) \
-    printf("%-79s\n", (s))
-#define LOG(l,...) \
-  if(midi.get_initialize() && l == midi.get_verbose()) printf(__VA_ARGS__)
-#define ERROR(...) \
-  if(!midi.get_csv()) { std::cerr << __VA_ARGS__ << std::endl; }
-#define FLUSH() \
-  if (!midi.get_initialize() && midi.get_verbose() > 0) fflush(stdout)
-
-# define CSV(t,...) \
-  if(midi.get_initialize() && midi.get_csv(t)) printf(__VA_ARGS__)
-# define CSV_TEXT(t,c,s) \
-  if(midi.get_initialize() && midi.get_csv(t)) do { \
-    printf("%s, \"",c); \
-    for (size_t i=0; i<strlen(s); ++i) { \
-      if (s[i] == '\"') printf("\"\""); \
-      else if ((s[i]<' ') || ((s[i]>'~') && (s[i]<=160))) \
-        printf("\\%03o", s[i]); \
-      else printf("%c", s[i]); } \
-    printf("\"\n"); \
-  } while(0);
+/*
+ * The output macros only produce code for the modes which the execution
+ * policy policy_t in scope allows, see MIDIPolicyRuntime below.
+ * Playback output goes through MIDILog so it never blocks the sequencer.
+ */
+#define DISPLAY(l,...) do { \
+  if constexpr (policy_t::initialize) { \
+    if(midi.get_initialize() && l <= midi.get_verbose()) printf(__VA_ARGS__); \
+  } } while(0)
+#define MESSAGE(l,...) do { \
+  if constexpr (policy_t::play) { \
+    if(!midi.get_initialize() && midi.get_verbose() >= l) \
+      MIDILog::instance().message(__VA_ARGS__); \
+  } } while(0)
+#define STATUS(...) do { \
+  if constexpr (policy_t::play) { \
+    if(!midi.get_initialize() && midi.get_verbose() >= 1) \
+      MIDILog::instance().status(__VA_ARGS__); \
+  } } while(0)
+#define INFO(s) do { \
+  if constexpr (policy_t::play) { \
+    if(!midi.get_initialize() && midi.get_verbose() >= 1 && !midi.get_lyrics()) \
+      MIDILog::instance().message("%-79s\n", (s)); \
+  } } while(0)
+#define LOG(l,...) do { \
+  if constexpr (policy_t::initialize) { \
+    if(midi.get_initialize() && l == midi.get_verbose()) printf(__VA_ARGS__); \
+  } } while(0)
+#define ERROR(...) do { \
+  if(!midi.get_csv()) { std::cerr << __VA_ARGS__ << std::endl; } \
+  } while(0)
+#define FLUSH() do { \
+  if constexpr (policy_t::play) { \
+    if (!midi.get_initialize() && midi.get_verbose() > 0) \
+      MIDILog::instance().flush(); \
+  } } while(0)
+
+# define CSV(t,...) do { \
+  if constexpr (policy_t::csv) { \
+    if(midi.get_initialize() && midi.get_csv(t)) printf(__VA_ARGS__); \
+  } } while(0)
+# define CSV_TEXT(t,c,s) do { \
+  if constexpr (policy_t::csv) { \
+    if(midi.get_initialize() && midi.get_csv(t)) { \
+      printf("%s, \"",c); \
+      for (size_t i=0; i<strlen(s); ++i) { \
+        if (s[i] == '\"') printf("\"\""); \
+        else if ((s[i]<' ') || ((s[i]>'~') && (s[i]<=160))) \
+          printf("\\%03o", s[i]); \
+        else printf("%c", s[i]); } \
+      printf("\"\n"); \
+    } \
+  } } while(0)
 
 
 namespace aeonwave
 {
+
+/*
+ * Execution policies of the event dispatcher.
+ *
+ * The same dispatcher serves playback, the initialization dry run, the
+ * CSV export and grep. Each mode gets its own instantiation so the output
+ * it can never produce is compiled out of its hot path, grep only differs
+ * from the scan in what the ensembles load so it uses MIDIPolicyScan.
+ * Source files which are not specialized declare
+ *   using policy_t = MIDIPolicyRuntime;
+ * and check everything at run time.
+ */
+struct MIDIPolicyRuntime
+{
+    static constexpr bool play = true;
+    static constexpr bool initialize = true;
+    static constexpr bool csv = true;
+};
+
+struct MIDIPolicyPlay
+{
+    static constexpr bool play = true;
+    static constexpr bool initialize = false;
+    static constexpr bool csv = false;
+};
+
+struct MIDIPolicyScan
+{
+    static constexpr bool play = false;
+    static constexpr bool initialize = true;
+    static constexpr bool csv = false;
+};
+
+struct MIDIPolicyCSVExport : public MIDIPolicyScan
+{
+    static constexpr bool csv = true;
+};
+
 #define MIDI_DRUMS_CHANNEL              0x9
 #define MIDI_DRUMS_CHANNEL_MT32		0x3f80
 #define MIDI_DRUMS_CHANNEL_XG		0x3f00
@@ -0,0 +1,192 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave MIDI library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#include <cstring>
+
+#include <midi/stats.hpp>
+
+using namespace aax;
+
+void
+MIDIStats::reset()
+{
+    for (auto& it : events) {
+        it.set(0);
+    }
+
+    process_calls.set(0);
+    process_time_us.set(0);
+    process_time_max_us.set(0);
+
+    cache_hits.set(0);
+    cache_misses.set(0);
+
+    patch_loads.set(0);
+    patch_load_time_us.set(0);
+    patch_load_time_max_us.set(0);
+
+    for (auto& it : channels)
+    {
+        it.peak.set(0);
+        it.retriggered.set(0);
+    }
+    rewind();
+}
+
+// All channels get deleted on rewind, and so do their voices.
+void
+MIDIStats::rewind()
+{
+    for (auto& it : channels)
+    {
+        it.down.reset();
+        it.keys.set(0);
+        it.active.set(0);
+    }
+}
+
+void
+MIDIStats::event(uint8_t message)
+{
+    uint8_t type;
+
+    switch(message)
+    {
+    case MIDI_SYSTEM_EXCLUSIVE:
+    case MIDI_SYSTEM_EXCLUSIVE_END:
+        type = AAX_MIDI_SYSTEM_EXCLUSIVE_EVENT;
+        break;
+    case MIDI_FILE_META_EVENT:
+        type = AAX_MIDI_META_EVENT;
+        break;
+    default:
+        // a data byte without running status is counted as a system event
+        if (message >= MIDI_SYSTEM || message < MIDI_NOTE_OFF) {
+            type = AAX_MIDI_SYSTEM_EVENT;
+        } else { // MIDI_NOTE_OFF .. MIDI_PITCH_BEND
+            type = ((message & 0xf0) - MIDI_NOTE_OFF) >> 4;
+        }
+        break;
+    }
+    events[type].add();
+}
+
+void
+MIDIStats::process(clock::time_point start)
+{
+    uint32_t us = elapsed_us(start);
+
+    process_calls.add();
+    process_time_us.add(us);
+    process_time_max_us.set_max(us);
+}
+
+void
+MIDIStats::patch_load(clock::time_point start)
+{
+    uint32_t us = elapsed_us(start);
+
+    patch_loads.add();
+    patch_load_time_us.add(us);
+    patch_load_time_max_us.set_max(us);
+}
+
+void
+MIDIStats::note_on(uint16_t channel, uint8_t key)
+{
+    if (channel >= channels.size() || key >= 128) return;
+
+    auto& c = channels[channel];
+    if (c.down.test(key)) {
+        c.retriggered.add();
+    }
+    else
+    {
+        c.down.set(key);
+        c.keys.add();
+    }
+}
+
+void
+MIDIStats::note_off(uint16_t channel, uint8_t key)
+{
+    if (channel >= channels.size() || key >= 128) return;
+
+    auto& c = channels[channel];
+    if (c.down.test(key))
+    {
+        c.down.reset(key);
+        c.keys.sub();
+    }
+}
+
+void
+MIDIStats::all_notes_off(uint16_t channel)
+{
+    if (channel >= channels.size()) return;
+
+    auto& c = channels[channel];
+    c.down.reset();
+    c.keys.set(0);
+}
+
+void
+MIDIStats::voices(uint16_t channel, uint32_t active)
+{
+    if (channel >= channels.size()) return;
+
+    auto& c = channels[channel];
+    c.active.set(active);
+    c.peak.set_max(active);
+}
+
+void
+MIDIStats::graph(uint32_t e, uint32_t m, uint32_t c, uint32_t d, uint32_t r)
+{
+    ensembles.set(e);
+    mixers.set(m);
+    chorus_parts.set(c);
+    delay_parts.set(d);
+    reverb_parts.set(r);
+}
+
+void
+MIDIStats::get(aaxMIDIStats& s) const
+{
+    memset(&s, 0, sizeof(aaxMIDIStats));
+
+    for (size_t i=0; i<events.size(); ++i) {
+        s.events[i] = events[i].get();
+    }
+
+    s.process_calls = process_calls.get();
+    s.process_time_us = process_time_us.get();
+    s.process_time_max_us = process_time_max_us.get();
+
+    s.cache_hits = cache_hits.get();
+    s.cache_misses = cache_misses.get();
+
+    s.patch_loads = patch_loads.get();
+    s.patch_load_time_us = patch_load_time_us.get();
+    s.patch_load_time_max_us = patch_load_time_max_us.get();
+
+    s.ensembles = ensembles.get();
+    s.mixers = mixers.get();
+    s.chorus_parts = chorus_parts.get();
+    s.delay_parts = delay_parts.get();
+    s.reverb_parts = reverb_parts.get();
+
+    for (size_t i=0; i<channels.size(); ++i)
+    {
+        s.voices[i].keys = channels[i].keys.get();
+        s.voices[i].active = channels[i].active.get();
+        s.voices[i].peak = channels[i].peak.get();
+        s.voices[i].retriggered = channels[i].retriggered.get();
+    }
+}
@@ -0,0 +1,123 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave MIDI library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <bitset>
+#include <chrono>
+
+#include <aax/midi.h>
+
+namespace aeonwave
+{
+
+/*
+ * A counter which is only ever updated by the sequencer thread but which
+ * may be read by any other thread. With a single writer there is no need
+ * for a locked read-modify-write, a relaxed load and store will do.
+ */
+template <typename T>
+class stats_counter
+{
+public:
+    inline void add(T v = 1) {
+        c.store(c.load(std::memory_order_relaxed)+v, std::memory_order_relaxed);
+    }
+    inline void sub(T v = 1) {
+        c.store(c.load(std::memory_order_relaxed)-v, std::memory_order_relaxed);
+    }
+    inline void set(T v) { c.store(v, std::memory_order_relaxed); }
+    inline void set_max(T v) { if (v > get()) set(v); }
+    inline T get() const { return c.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<T> c{0};
+};
+
+class MIDIStats
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    MIDIStats() = default;
+    ~MIDIStats() = default;
+
+    void reset();
+    void rewind();
+
+    void event(uint8_t message);
+    void process(clock::time_point start);
+    void cache(bool hit) { hit ? cache_hits.add() : cache_misses.add(); }
+    void patch_load(clock::time_point start);
+
+    void note_on(uint16_t channel, uint8_t key);
+    void note_off(uint16_t channel, uint8_t key);
+    void all_notes_off(uint16_t channel);
+
+    // the number of voices which the ensemble of the channel plays
+    void voices(uint16_t channel, uint32_t active);
+
+    void graph(uint32_t ensembles, uint32_t mixers,
+               uint32_t chorus, uint32_t delay, uint32_t reverb);
+
+    void get(aaxMIDIStats& s) const;
+
+private:
+    static uint32_t elapsed_us(clock::time_point start) {
+        auto dt = clock::now() - start;
+        return std::chrono::duration_cast<std::chrono::microseconds>(dt).count();
+    }
+
+    std::array<stats_counter<uint64_t>, AAX_MIDI_EVENT_MAX> events;
+
+    stats_counter<uint64_t> process_calls;
+    stats_counter<uint64_t> process_time_us;
+    stats_counter<uint32_t> process_time_max_us;
+
+    stats_counter<uint64_t> cache_hits;
+    stats_counter<uint64_t> cache_misses;
+
+    stats_counter<uint32_t> patch_loads;
+    stats_counter<uint64_t> patch_load_time_us;
+    stats_counter<uint32_t> patch_load_time_max_us;
+
+    stats_counter<uint32_t> ensembles;
+    stats_counter<uint32_t> mixers;
+    stats_counter<uint32_t> chorus_parts;
+    stats_counter<uint32_t> delay_parts;
+    stats_counter<uint32_t> reverb_parts;
+
+    struct channel_t
+    {
+        std::bitset<128> down; // sequencer thread only
+        stats_counter<uint32_t> keys;
+        stats_counter<uint32_t> active;
+        stats_counter<uint32_t> peak;
+        stats_counter<uint32_t> retriggered;
+    };
+    std::array<channel_t, MIDI_STATS_MAX_CHANNELS> channels;
+};
+
+// Accounts the time spent in the current scope as one process() call.
+class stats_process_scope
+{
+public:
+    stats_process_scope(MIDIStats& s)
+        : stats(s), start(MIDIStats::clock::now()) {}
+    ~stats_process_scope() { stats.process(start); }
+
+private:
+    MIDIStats& stats;
+    MIDIStats::clock::time_point start;
+};
+
+} // namespace aeonwave
+
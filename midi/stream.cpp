@@ -28,14 +28,20 @@
 #include <midi/driver.hpp>
 
 using namespace aax;
+using policy_t = MIDIPolicyRuntime;
 
 MIDIStream::MIDIStream(MIDIDriver& ptr, byte_stream& stream, size_t len,  uint16_t track)
-    : byte_stream(stream, len), midi(ptr), m_mt((std::random_device())()),
-      track_no(track)
+    : byte_stream(stream, len), midi(ptr), track_no(track)
 {
     timestamp_parts = pull_message()*24/600000;
 }
 
+// live input streams have no delta-time
+MIDIStream::MIDIStream(MIDIDriver& ptr, byte_stream& stream, uint16_t track)
+    : byte_stream(stream), midi(ptr), track_no(track)
+{
+}
+
 float
 MIDIStream::cents2pitch(float cents, uint8_t channel)
 {
@@ -43,11 +49,23 @@ MIDIStream::cents2pitch(float cents, uint8_t channel)
     return powf(2.0f, cents*semitones/12.0f);
 }
 
+// cents2pitch(s*value/127.0f, channel) for a 7-bit pressure value
+float
+MIDIStream::pressure2pitch(uint8_t value, uint8_t channel_no)
+{
+    auto& channel = midi.channel(channel_no);
+    float s = channel.get_aftertouch_sensitivity();
+    float scale = s*channel.get_pitch_depth()/(12.0f*127.0f);
+    return midi.get_curves(channel_no).pressure.get(value, scale);
+}
+
+// 2^(depth*moddepth/12) for depth = float(value << 7)/16383.0f
 float
-MIDIStream::cents2modulation(float cents, uint8_t channel)
+MIDIStream::modulation2pitch(uint8_t value, uint8_t channel_no)
 {
-    float moddepth = midi.channel(channel).get_modulation_depth();
-    return powf(2.0f, cents*moddepth/12.0f);
+    float moddepth = midi.channel(channel_no).get_modulation_depth();
+    float scale = 128.0f*moddepth/(12.0f*16383.0f);
+    return midi.get_curves(channel_no).modulation.get(value, scale);
 }
 
 // Variable-length quantity
@@ -69,6 +87,31 @@ MIDIStream::pull_message()
     return rv;
 }
 
+// Reads size bytes of ISO-8859-1 text and converts them to zero
+// terminated UTF-8 in the song arena, carriage returns become newlines.
+std::string_view
+MIDIStream::pull_text(size_t size)
+{
+    auto& arena = midi.get_song_arena();
+    char *text = static_cast<char*>(arena.allocate(2*size+1, 1));
+    size_t len = 0;
+
+    for (size_t i=0; i<size; ++i)
+    {
+        uint8_t c = pull_byte();
+        if (c < 128) {
+            text[len++] = (c == '\r') ? '\n' : c;
+        }
+        else if (c >= 160) { // skip control characters
+            text[len++] = 0xc2+(c > 0xbf);
+            text[len++] = (c & 0x3f)+0x80;
+        }
+    }
+    text[len] = 0;
+
+    return std::string_view(text, len);
+}
+
 
 // https://www.midi.org/specifications-old/item/table-3-control-change-messages-data-bytes-2
 bool
@@ -88,68 +131,77 @@ MIDIStream::registered_param(uint8_t channel, uint8_t controller, uint8_t value,
  push_byte();
 #endif
 
-    if (controller != prev_controller)
-    {
-        prev_controller = controller;
-        rpn = true;
-    }
+    // the parameter state belongs to the MIDI channel, not to the track
+    auto& params = midi.get_params(channel);
+    bool enabled_param = params.is_registered() ? enabled[SWITCH_RPN]
+                                                : enabled[SWITCH_NRPN];
+    bool active = enabled_param && params.selected();
 
     switch(controller)
     {
     case MIDI_REGISTERED_PARAM_COARSE:
         expl = "REGISTERED_PARAM_COARSE";
-        msb_type = type;
+        params.select_coarse(true, value);
         break;
     case MIDI_REGISTERED_PARAM_FINE:
         expl = "REGISTERED_PARAM_FINE";
-        lsb_type = type;
+        params.select_fine(true, value);
+        break;
+    case MIDI_UNREGISTERED_PARAM_COARSE:
+        expl = "UNREGISTERED_PARAM_COARSE";
+        params.select_coarse(false, value);
+        break;
+    case MIDI_UNREGISTERED_PARAM_FINE:
+        expl = "UNREGISTERED_PARAM_FINE";
+        params.select_fine(false, value);
         break;
     case MIDI_DATA_ENTRY:
         expl = "DATA_ENTRY_COARSE";
-        if (rpn && registered)
+        if (active)
         {
-            param[msb_type << 7 | lsb_type].coarse = value;
+            param_t *p = params.get();
+            if (p) p->coarse = value;
             data = true;
         }
         break;
     case MIDI_DATA_ENTRY|MIDI_FINE:
         expl = "DATA_ENTRY_FINE";
-        if (rpn && registered)
+        if (active)
         {
-            param[msb_type << 7 | lsb_type].fine = value;
+            param_t *p = params.get();
+            if (p) p->fine = value;
             data = true;
         }
         break;
     case MIDI_DATA_INCREMENT:
         expl = "DATA_INCREMENT";
-        if (rpn)
+        if (active)
         {
-            type = msb_type << 8 | lsb_type;
-            if (++param[type].fine == 128) {
-                param[type].coarse++;
-                param[type].fine = 0;
+            param_t *p = params.get();
+            if (p && ++p->fine == 128) {
+                p->coarse++;
+                p->fine = 0;
             }
+            data = true;
         }
         break;
     case MIDI_DATA_DECREMENT:
         expl = "DATA_DECREMENT";
-        if (rpn)
+        if (active)
         {
-            type = msb_type << 8 | lsb_type;
-            if (param[type].fine == 0) {
-                param[type].coarse--;
-                param[type].fine = 127;
-            } else {
-                param[type].fine--;
+            param_t *p = params.get();
+            if (p)
+            {
+                if (p->fine == 0) {
+                    p->coarse--;
+                    p->fine = 127;
+                } else {
+                    p->fine--;
+                }
             }
+            data = true;
         }
         break;
-    case MIDI_UNREGISTERED_PARAM_COARSE:
-        expl = "UNREGISTERED_PARAM_COARSE";
-        break;
-    case MIDI_UNREGISTERED_PARAM_FINE:
-        expl = "UNREGISTERED_PARAM_FINE";
-        break;
     default:
         expl = "Unkown REGISTERED_PARAM";
         LOG(99, "LOG: Unsupported registered parameter controller: %x\n", controller);
@@ -157,17 +209,20 @@ MIDIStream::registered_param(uint8_t channel, uint8_t controller, uint8_t value,
         break;
     }
 
-    if (data)
+    // A selected MIDI_NULL_FUNCTION_NUMBER disables the data entry, data
+    // increment, and data decrement controllers until a new RPN or NRPN
+    // is selected, see MIDIParams::selected().
+    if (data && params.is_registered())
     {
-        type = msb_type << 8 | lsb_type;
+        type = params.get_type();
         switch(type)
         {
         case MIDI_PITCH_BEND_SENSITIVITY:
         {
             expl = "PITCH_BEND_SENSITIVITY";
             float val;
-            val = float(param[MIDI_PITCH_BEND_SENSITIVITY].coarse) +
-                  float(param[MIDI_PITCH_BEND_SENSITIVITY].fine*0.01f);
+            val = float(params.get_rpn(MIDI_PITCH_BEND_SENSITIVITY).coarse) +
+                  float(params.get_rpn(MIDI_PITCH_BEND_SENSITIVITY).fine*0.01f);
             midi.channel(channel).set_pitch_depth(val);
             break;
         }
@@ -175,16 +230,16 @@ MIDIStream::registered_param(uint8_t channel, uint8_t controller, uint8_t value,
             expl = "MODULATION_DEPTH_RANGE";
         {
             float val;
-            val = float(param[MIDI_MODULATION_DEPTH_RANGE].coarse) +
-                  float(param[MIDI_MODULATION_DEPTH_RANGE].fine*0.01f);
+            val = float(params.get_rpn(MIDI_MODULATION_DEPTH_RANGE).coarse) +
+                  float(params.get_rpn(MIDI_MODULATION_DEPTH_RANGE).fine*0.01f);
             midi.channel(channel).set_modulation_depth(val);
             break;
         }
         case MIDI_CHANNEL_FINE_TUNING:
         { // 0x00 0x00 = -100 cents; 0x40 0x00 = A440; 0x7F 0x7F = +100 cents.
             expl = "CHANNEL_FINE_TUNING";
-            int32_t tuning = param[MIDI_CHANNEL_FINE_TUNING].coarse << 7
-                              | param[MIDI_CHANNEL_FINE_TUNING].fine;
+            int32_t tuning = params.get_rpn(MIDI_CHANNEL_FINE_TUNING).coarse << 7
+                              | params.get_rpn(MIDI_CHANNEL_FINE_TUNING).fine;
             float cents = 100.0f*float(tuning-8192)/8192.0f;
             midi.channel(channel).set_tuning_fine(cents);
             break;
@@ -192,17 +247,11 @@ MIDIStream::registered_param(uint8_t channel, uint8_t controller, uint8_t value,
         case MIDI_CHANNEL_COARSE_TUNING:
         {   // 0x00 = -64 semitones; 0x40 = A440; 0x7F = +63 semitones.
             expl = "CHANNEL_COARSE_TUNING";
-            int32_t tuning = param[MIDI_CHANNEL_COARSE_TUNING].coarse;
+            int32_t tuning = params.get_rpn(MIDI_CHANNEL_COARSE_TUNING).coarse;
             float semitones = float(tuning-64);
             midi.channel(channel).set_tuning_coarse(semitones);
             break;
         }
-        case MIDI_NULL_FUNCTION_NUMBER:
-            expl = "NULL_FUNCTION_NUMBER";
-            // disable the data entry, data increment, and data decrement
-            // controllers until a new RPN or NRPN is selected.
-            rpn = false;
-            break;
         case MIDI_MPE_CONFIGURATION_MESSAGE:
             expl = "MPE_CONFIGURATION_MESSAGE";
             break;
@@ -221,7 +270,7 @@ MIDIStream::registered_param(uint8_t channel, uint8_t controller, uint8_t value,
         default:
             expl = "Unkown REGISTERED_PARAM_TYPE";
             LOG(99, "LOG: Unsupported registered parameter type: 0x%x/0x%x\n",
-                     msb_type, lsb_type);
+                     type >> 8, type & 0xff);
             break;
         }
     }
@@ -272,207 +321,283 @@ MIDIStream::process(uint64_t time_offs_parts, uint32_t& elapsed_parts, uint32_t&
         return rv;
     }
 
+    if (!midi.get_initialize()) {
+        process_events<MIDIPolicyPlay>(time_offs_parts);
+    } else if (midi.get_csv()) {
+        process_events<MIDIPolicyCSVExport>(time_offs_parts);
+    } else {
+        process_events<MIDIPolicyScan>(time_offs_parts);
+    }
+    next = wait_parts;
+
+    return rv;
+}
+
+template<class policy_t>
+void
+MIDIStream::process_events(uint64_t time_offs_parts)
+{
     while (!eof() && (timestamp_parts <= time_offs_parts))
     {
         CSV(channel_no, "%d, %ld, ", channel_no, timestamp_parts);
 
-        // Handle running status; if the next byte is a data byte
-        // reuse the last command seen in the track
-        uint32_t message = pull_byte();
-        if ((message & 0x80) == 0)
-        {
-            push_byte();
-            message = previous;
-        }
-        else if ((message & 0xF0) != 0xF0)
+        process_event<policy_t>();
+
+        if (!eof())
         {
-            // System messages and file meta-events (all of which are in the
-            // 0xF0-0xFF range) are not saved, as it is possible to carry a
-            // running status across them.
-            previous = message;
+            wait_parts = pull_message();
+            timestamp_parts += wait_parts;
         }
+    } // while (!eof() && (timestamp_parts <= time_offs_parts))
+}
 
-        rv = true;
-        switch(message)
-        {
-        case MIDI_SYSTEM_EXCLUSIVE_END:
-            // When reading a MIDI File, and an F7 sysex event is encountered
-            // without a preceding F0 sysex event to start a multi-packet system
-            // exclusive message sequence, it should be presumed that the F7
-            // event is being used as an "escape".
+bool
+MIDIStream::process(uint8_t *message, size_t len)
+{
+    assign(message, len);
+    byte_stream::rewind();
+    return process_event();
+}
+
+template<class policy_t>
+bool
+MIDIStream::dispatch(size_t offs)
+{
+    byte_stream::rewind();
+    forward(offs);
+    return process_event<policy_t>();
+}
+
+// the song timeline is not used by the CSV export
+template bool MIDIStream::dispatch<MIDIPolicyPlay>(size_t);
+template bool MIDIStream::dispatch<MIDIPolicyScan>(size_t);
+
+// Process a complete message which the look-ahead parser copied from
+// the track, the parser only runs while playing.
+bool
+MIDIStream::dispatch(const uint8_t *message, size_t len)
+{
+    uint8_map track(*this);
+    bool rv;
+
+    assign(const_cast<uint8_t*>(message), len);
+    byte_stream::rewind();
+    try {
+        rv = process_event<MIDIPolicyPlay>();
+    } catch (...) {
+        assign(track, track.size());
+        throw;
+    }
+    assign(track, track.size());
+
+    return rv;
+}
+
+bool
+MIDIStream::process_event()
+{
+    if (!midi.get_initialize()) {
+        return process_event<MIDIPolicyPlay>();
+    } else if (midi.get_csv()) {
+        return process_event<MIDIPolicyCSVExport>();
+    }
+    return process_event<MIDIPolicyScan>();
+}
+
+template<class policy_t>
+bool
+MIDIStream::process_event()
+{
+    // Handle running status; if the next byte is a data byte
+    // reuse the last command seen in the track
+    uint32_t message = pull_byte();
+    if ((message & 0x80) == 0)
+    {
+        push_byte();
+        message = previous;
+    }
+    else if ((message & 0xF0) != 0xF0)
+    {
+        // System messages and file meta-events (all of which are in the
+        // 0xF0-0xFF range) are not saved, as it is possible to carry a
+        // running status across them.
+        previous = message;
+    }
+    midi.stats().event(message);
+
+    switch(message)
+    {
+    case MIDI_SYSTEM_EXCLUSIVE_END:
+        // When reading a MIDI File, and an F7 sysex event is encountered
+        // without a preceding F0 sysex event to start a multi-packet system
+        // exclusive message sequence, it should be presumed that the F7
+        // event is being used as an "escape".
 // http://www.music.mcgill.ca/~ich/classes/mumt306/StandardMIDIfileformat.html
-            CSV(channel_no, "%d", message);
-            break;
-        case MIDI_SYSTEM_EXCLUSIVE:
-            process_sysex();
+        CSV(channel_no, "%d", message);
+        break;
+    case MIDI_SYSTEM_EXCLUSIVE:
+        process_sysex<policy_t>(pull_message());
+        break;
+    case MIDI_FILE_META_EVENT:
+        process_meta<policy_t>();
+        break;
+    default:
+    {
+        uint8_t channel_no = message & 0xf;
+        auto& channel = midi.channel(channel_no);
+        switch(message & 0xf0)
+        {
+        case MIDI_NOTE_ON:
+        {
+            if (!enabled[SWITCH_NOTE_MESSAGE]) break;
+            int note_no = pull_byte();
+            uint8_t velocity = pull_byte();
+            CSV(channel_no, "Note_on_c, %d, %d, %d, NOTE_%s VELOCITY: %.0f%%\n", channel_no, note_no, velocity, velocity ? "ON" : "OFF", float(velocity)/1.27f);
+            if (note_no < key_range_low || note_no > key_range_high) break;
+            if (velocity && midi.is_track_muted(track_no)) break;
+            try {
+                midi.process(channel_no, message & 0xf0, note_no, velocity, omni);
+            } catch (const std::runtime_error &e) {
+                throw(e);
+            }
             break;
-        case MIDI_FILE_META_EVENT:
-            process_meta();
+        }
+        case MIDI_NOTE_OFF:
+        {
+            if (!enabled[SWITCH_NOTE_MESSAGE]) break;
+            int16_t note_no = pull_byte();
+            uint8_t velocity = pull_byte();
+            midi.process(channel_no, message & 0xf0, note_no, velocity, omni);
+            CSV(channel_no, "Note_off_c, %d, %d, %d, NOTE_OFF\n", channel_no, note_no, velocity);
             break;
-        default:
+        }
+        case MIDI_POLYPHONIC_AFTERTOUCH:
         {
-            uint8_t channel_no = message & 0xf;
-            auto& channel = midi.channel(channel_no);
-            switch(message & 0xf0)
+            if (!enabled[SWITCH_POLY_PRESSURE]) break;
+            uint8_t note_no = pull_byte();
+            uint8_t pressure = pull_byte();
+            if (!channel.is_drums())
             {
-            case MIDI_NOTE_ON:
-            {
-                if (!note_message_enabled) break;
-                int note_no = pull_byte();
-                uint8_t velocity = pull_byte();
-                CSV(channel_no, "Note_on_c, %d, %d, %d, NOTE_%s VELOCITY: %.0f%%\n", channel_no, note_no, velocity, velocity ? "ON" : "OFF", float(velocity)/1.27f);
-                if (note_no < key_range_low || note_no > key_range_high) break;
-                try {
-                    midi.process(channel_no, message & 0xf0, note_no, velocity, omni);
-                } catch (const std::runtime_error &e) {
-                    throw(e);
+                if (channel.get_pressure_pitch_bend()) {
+                    channel.set_pitch(note_no, pressure2pitch(pressure, channel_no));
+                }
+                if (channel.get_pressure_volume_bend()) {
+                    channel.set_pressure(note_no, 1.0f-0.33f*pressure/127.0f);
                 }
-                break;
             }
-            case MIDI_NOTE_OFF:
+            CSV(channel_no, "Poly_aftertouch_c, %d, %d, %d\n", channel_no, note_no, pressure);
+            break;
+        }
+        case MIDI_CHANNEL_AFTERTOUCH:
+        {
+            if (!enabled[SWITCH_CHANNEL_PRESSURE]) break;
+            uint8_t pressure = pull_byte();
+            if (!channel.is_drums())
             {
-                if (!note_message_enabled) break;
-                int16_t note_no = pull_byte();
-                uint8_t velocity = pull_byte();
-                midi.process(channel_no, message & 0xf0, note_no, velocity, omni);
-                CSV(channel_no, "Note_off_c, %d, %d, %d, NOTE_OFF\n", channel_no, note_no, velocity);
-                break;
+                if (channel.get_pressure_pitch_bend()) {
+                    channel.set_pitch(pressure2pitch(pressure, channel_no));
+                }
+                if (channel.get_pressure_volume_bend()) {
+                    channel.set_pressure(1.0f-0.33f*pressure/127.0f);
+                }
             }
-            case MIDI_POLYPHONIC_AFTERTOUCH:
-            {
-                if (!poly_pressure_enabled) break;
-                uint8_t note_no = pull_byte();
-                uint8_t pressure = pull_byte();
-                if (!channel.is_drums())
+            CSV(channel_no, "Channel_aftertouch_c, %d, %d\n", channel_no, pressure);
+            break;
+        }
+        case MIDI_PITCH_BEND:
+        {
+            if (!enabled[SWITCH_PITCH_BEND]) break;
+            int32_t pitch = pull_byte() | pull_byte() << 7;
+            auto& curve = midi.get_curves(channel_no).pitch_bend;
+            channel.set_pitch(curve.get(pitch, channel.get_pitch_depth()));
+            CSV(channel_no, "Pitch_bend_c, %d, %d, PITCH_BEND\n", channel_no, pitch);
+            break;
+        }
+        case MIDI_CONTROL_CHANGE:
+        {
+            if (!enabled[SWITCH_CONTROL_CHANGE]) break;
+            process_control<policy_t>(channel_no);
+            break;
+        }
+        case MIDI_PROGRAM_CHANGE:
+        {
+            if (!enabled[SWITCH_PROGRAM_CHANGE]) break;
+            uint16_t bank_no = channel.get_bank_no();
+            uint8_t program_no = pull_byte();
+            CSV(channel_no, "Program_c, %d, %d, PROGRAM_CHANGE\n", channel_no, program_no);
+            if (policy_t::play && !midi.get_initialize()) {
+                MIDITrace::instance().instant("program-change", "channel",
+                                          channel_no, "program", program_no);
+            }
+            try {
+                midi.new_channel(channel_no, bank_no, program_no, true);
+                if (midi.is_drums(channel_no))
                 {
-                    float s = channel.get_aftertouch_sensitivity();
-                    if (channel.get_pressure_pitch_bend()) {
-                        channel.set_pitch(note_no, cents2pitch(s*pressure/127.0f, channel_no));
-                    }
-                    if (channel.get_pressure_volume_bend()) {
-                        channel.set_pressure(note_no, 1.0f-0.33f*pressure/127.0f);
+                    auto& frames = midi.get_configurations();
+                    auto it = frames.find(program_no);
+                    if (it != frames.end()) {
+                        name = it->second[0].name;
                     }
                 }
-                CSV(channel_no, "Poly_aftertouch_c, %d, %d, %d\n", channel_no, note_no, pressure);
-                break;
-            }
-            case MIDI_CHANNEL_AFTERTOUCH:
-            {
-                if (!channel_pressure_enabled) break;
-                uint8_t pressure = pull_byte();
-                if (!channel.is_drums())
+                else
                 {
-                    float s = channel.get_aftertouch_sensitivity();
-                    if (channel.get_pressure_pitch_bend()) {
-                        channel.set_pitch(cents2pitch(s*pressure/127.0f, channel_no));
-                    }
-                    if (channel.get_pressure_volume_bend()) {
-                        channel.set_pressure(1.0f-0.33f*pressure/127.0f);
-                    }
+                    auto& inst = midi.get_instrument(bank_no, program_no);
+                    if (inst.size()) name = inst[0].name;
                 }
-                CSV(channel_no, "Channel_aftertouch_c, %d, %d\n", channel_no, pressure);
-                break;
+            } catch(const std::invalid_argument& e) {
+                ERROR("Error: " << e.what());
             }
-            case MIDI_PITCH_BEND:
+            break;
+        }
+        case MIDI_SYSTEM:
+            switch(channel_no)
             {
-                if (!pitch_bend_enabled) break;
-                int32_t pitch = pull_byte() | pull_byte() << 7;
-                float pitch_bend = float(pitch-8192);
-                if (pitch_bend < 0) pitch_bend /= 8192.0f;
-                else pitch_bend /= 8191.0f;
-                pitch_bend = cents2pitch(pitch_bend, channel_no);
-                channel.set_pitch(pitch_bend);
-                CSV(channel_no, "Pitch_bend_c, %d, %d, PITCH_BEND\n", channel_no, pitch);
+            case MIDI_TIMING_CODE:
+                pull_byte();
                 break;
-            }
-            case MIDI_CONTROL_CHANGE:
-            {
-                if (!control_change_enabled) break;
-                process_control(channel_no);
+            case MIDI_POSITION_POINTER:
+                pull_byte();
+                pull_byte();
                 break;
-            }
-            case MIDI_PROGRAM_CHANGE:
-            {
-                if (!program_change_enabled) break;
-                uint16_t bank_no = channel.get_bank_no();
-                uint8_t program_no = pull_byte();
-                CSV(channel_no, "Program_c, %d, %d, PROGRAM_CHANGE\n", channel_no, program_no);
-                try {
-                    midi.new_channel(channel_no, bank_no, program_no);
-                    if (midi.is_drums(channel_no))
-                    {
-                        auto& frames = midi.get_configurations();
-                        auto it = frames.find(program_no);
-                        if (it != frames.end()) {
-                            name = it->second[0].name;
-                        }
-                    }
-                    else
-                    {
-                        auto& inst = midi.get_instrument(bank_no, program_no);
-                        if (inst.size()) name = inst[0].name;
-                    }
-                } catch(const std::invalid_argument& e) {
-                    ERROR("Error: " << e.what());
-                }
+            case MIDI_SONG_SELECT:
+                pull_byte();
                 break;
-            }
-            case MIDI_SYSTEM:
-                switch(channel_no)
-                {
-                case MIDI_TIMING_CODE:
-                    pull_byte();
-                    break;
-                case MIDI_POSITION_POINTER:
-                    pull_byte();
-                    pull_byte();
-                    break;
-                case MIDI_SONG_SELECT:
-                    pull_byte();
-                    break;
-                case MIDI_TUNE_REQUEST:
-                    break;
-                case MIDI_SYSTEM_RESET:
+            case MIDI_TUNE_REQUEST:
+                break;
+            case MIDI_SYSTEM_RESET:
 #if 0
-                    omni = true;
-                    polyphony = true;
-                    for(auto& it : midi.channel())
-                    {
-                        midi.process(it.first, MIDI_NOTE_OFF, 0, 0, true);
-                        midi.channel(channel).set_semi_tones(2.0f);
-                    }
-#endif
-                    break;
-                case MIDI_TIMING_CLOCK:
-                case MIDI_START:
-                case MIDI_CONTINUE:
-                case MIDI_STOP:
-                case MIDI_ACTIVE_SENSE:
-                    break;
-                default:
-                    LOG(99, "LOG: Unsupported real-time System message: 0x%x - %d\n", message, channel_no);
-                    break;
+                omni = true;
+                polyphony = true;
+                for(auto& it : midi.channel())
+                {
+                    midi.all_notes_off(it.first);
+                    midi.channel(channel).set_semi_tones(2.0f);
                 }
+#endif
+                break;
+            case MIDI_TIMING_CLOCK:
+            case MIDI_START:
+            case MIDI_CONTINUE:
+            case MIDI_STOP:
+            case MIDI_ACTIVE_SENSE:
                 break;
             default:
-                LOG(99, "LOG: Unsupported message: 0x%x\n", message);
+                LOG(99, "LOG: Unsupported real-time System message: 0x%x - %d\n", message, channel_no);
                 break;
             }
             break;
-        } // switch
-        } // default
-
-        if (!eof())
-        {
-            wait_parts = pull_message();
-            timestamp_parts += wait_parts;
+        default:
+            LOG(99, "LOG: Unsupported message: 0x%x\n", message);
+            break;
         }
-    } // while (!eof() && (timestamp_parts <= time_offs_parts))
-    next = wait_parts;
+        break;
+    } // switch
+    } // default
 
-    return rv;
+    return true;
 }
 
+template<class policy_t>
 bool MIDIStream::process_control(uint8_t track_no)
 {
     auto& channel = midi.channel(track_no);
@@ -489,7 +614,7 @@ bool MIDIStream::process_control(uint8_t track_no)
         channel.set_modulation(0.0f);
         channel.set_expression(127.0f/127.0f);
         channel.set_hold(false);
-        msb_type = lsb_type = 0x7F; // (UN)REGISTERED_PARAM
+        midi.get_params(track_no).deselect(); // (UN)REGISTERED_PARAM
         channel.set_pitch(64.0f/64.0f);
         channel.set_pressure(0.0f);
         channel.set_sustain(true);
@@ -501,7 +626,7 @@ bool MIDIStream::process_control(uint8_t track_no)
         break;
     case MIDI_MONO_ALL_NOTES_OFF:
         expl = "MONO_ALL_NOTES_OFF";
-        midi.process(track_no, MIDI_NOTE_OFF, 0, 0, true);
+        midi.all_notes_off(track_no);
         if (value == 1) {
             mode = MIDI_MONOPHONIC;
             channel.set_monophonic(true);
@@ -509,28 +634,28 @@ bool MIDIStream::process_control(uint8_t track_no)
         break;
     case MIDI_POLY_ALL_NOTES_OFF:
         expl = "POLY_ALL_NOTES_OFF";
-        midi.process(track_no, MIDI_NOTE_OFF, 0, 0, true);
+        midi.all_notes_off(track_no);
         channel.set_monophonic(false);
         mode = MIDI_POLYPHONIC;
         break;
     case MIDI_ALL_SOUND_OFF:
         expl = "ALL_SOUND_OFF";
-        midi.process(track_no, MIDI_NOTE_OFF, 0, 0, true);
+        midi.all_notes_off(track_no);
         break;
     case MIDI_OMNI_OFF:
         expl = "OMNI_OFF";
-        midi.process(track_no, MIDI_NOTE_OFF, 0, 0, true);
+        midi.all_notes_off(track_no);
         omni = false;
         break;
     case MIDI_OMNI_ON:
         expl = "OMNI_ON";
-        midi.process(track_no, MIDI_NOTE_OFF, 0, 0, true);
+        midi.all_notes_off(track_no);
         omni = true;
         break;
     case MIDI_BANK_SELECT:
     {
         expl = "BANK_SELECT MSB";
-        if (!bank_select_enabled) break;
+        if (!enabled[SWITCH_BANK_SELECT]) break;
         bool prev = channel.is_drums();
         bool drums = false;
         switch(midi.get_mode())
@@ -562,7 +687,7 @@ bool MIDIStream::process_control(uint8_t track_no)
     case MIDI_BANK_SELECT|MIDI_FINE:
     {
         expl = "BANK_SELECT LSB";
-        if (!bank_select_lsb_enabled) break;
+        if (!enabled[SWITCH_BANK_SELECT_LSB]) break;
         uint16_t bank_no = channel.get_bank_no();
         bool prev = channel.is_drums();
         bool drums = prev;
@@ -614,9 +739,8 @@ bool MIDIStream::process_control(uint8_t track_no)
 #else
         if (!channel.is_drums())
         {
-            float s = channel.get_aftertouch_sensitivity();
             if (channel.get_pressure_pitch_bend()) {
-                channel.set_pitch(cents2pitch(s*value/127.0f, track_no));
+                channel.set_pitch(pressure2pitch(value, track_no));
             }
             if (channel.get_pressure_volume_bend()) {
                 channel.set_pressure(1.0f-0.33f*value/127.0f);
@@ -629,7 +753,7 @@ bool MIDIStream::process_control(uint8_t track_no)
         break;
     case MIDI_PAN:
         expl = "PAN MSB";
-        if (!pan_enabled) break;
+        if (!enabled[SWITCH_PAN]) break;
         if (!midi.get_mono()) {
             channel.set_pan((float(value)-64.f)/64.f);
         }
@@ -637,59 +761,50 @@ bool MIDIStream::process_control(uint8_t track_no)
     case MIDI_EXPRESSION:
     {
         expl = "EXPRESSION MSB";
-        if (!expression_enabled) break;
+        if (!enabled[SWITCH_EXPRESSION]) break;
         // When Expression is at 100% then the volume represents the true
         // setting of Volume Controller. Lower values of Expression begin to
         // subtract from the volume. When Expression is 0% then volume is off.
-        channel.set_expression(aax::math::ln(float(value)/127.0f));
+        channel.set_expression(MIDICurves::gain(value));
         break;
     }
     case MIDI_MODULATION_DEPTH:
     {
         expl = "MODULATION_DEPTH";
-        if (!modulation_enabled) break;
-        float depth = float(value << 7)/16383.0f;
-        depth = cents2modulation(depth, track_no) - 1.0f;
+        if (!enabled[SWITCH_MODULATION]) break;
+        float depth = modulation2pitch(value, track_no) - 1.0f;
         channel.set_modulation(depth);
         break;
     }
     case MIDI_CELESTE_EFFECT_DEPTH:
     {
         expl = "CELESTE_EFFECT_DEPTH";
-        float level = float(value)/127.0f;
-        level = cents2pitch(level, track_no);
+        auto& curve = midi.get_curves(track_no).celeste;
+        float level = curve.get(value, channel.get_pitch_depth()/(12.0f*127.0f));
         channel.set_celeste_depth(level);
         break;
     }
     case MIDI_CHANNEL_VOLUME:
         expl = "CHANNEL_VOLUME";
-        if (!volume_enabled) break;
+        if (!enabled[SWITCH_VOLUME]) break;
         if (value && channel.get_gain() != float(value)/127.0f) {
             MESSAGE(4, "Set part %i volume to %.0f%%: %s\n", track_no,
-                        float(value)*100.0f/127.0f, name.c_str());
+                        float(value)*100.0f/127.0f, name.data());
         }
-        channel.set_gain(aax::math::ln(float(value)/127.0f));
+        channel.set_gain(MIDICurves::gain(value));
         break;
     case MIDI_ALL_NOTES_OFF:
         expl = "ALL_NOTES_OFF";
         for(auto& it : midi.get_channels())
         {
-            midi.process(it.first, MIDI_NOTE_OFF, 0, 0, true);
+            midi.all_notes_off(it.first);
             channel.set_pitch_depth(2.0f);
         }
         break;
     case MIDI_UNREGISTERED_PARAM_COARSE:
     case MIDI_UNREGISTERED_PARAM_FINE:
-        rpn = nrpn_enabled;
-        registered = false;
-        registered_param(track_no, controller, value, expl);
-        break;
     case MIDI_REGISTERED_PARAM_COARSE:
     case MIDI_REGISTERED_PARAM_FINE:
-        rpn = rpn_enabled;
-        registered = true;
-        registered_param(track_no, controller, value, expl);
-        break;
     case MIDI_DATA_ENTRY:
     case MIDI_DATA_ENTRY|MIDI_FINE:
     case MIDI_DATA_INCREMENT:
@@ -698,7 +813,7 @@ bool MIDIStream::process_control(uint8_t track_no)
         break;
     case MIDI_SOFT_PEDAL_SWITCH:
         expl = "SOFT_PEDAL_SWITCH";
-        if (!soft_enabled) break;
+        if (!enabled[SWITCH_SOFT]) break;
         channel.set_soft(float(value)/127.0f);
         break;
     case MIDI_LEGATO_SWITCH:
@@ -856,11 +971,15 @@ bool MIDIStream::process_control(uint8_t track_no)
     return rv;
 }
 
-bool MIDIStream::process_sysex()
+template<class policy_t>
+bool MIDIStream::process_sysex(uint64_t size)
 {
-    std::string expl = "Unkown";
+    // the explanation is only needed for the CSV output
+    bool csv = policy_t::csv && midi.get_csv(channel_no);
+    std::string expl;
+    if (csv) expl = "Unkown";
+
     bool rv = true;
-    uint64_t size = pull_message();
     uint64_t offs = offset();
     uint8_t byte = pull_byte();
 
@@ -876,30 +995,30 @@ bool MIDIStream::process_sysex()
     {
     case MIDI_SYSTEM_EXCLUSIVE_ROLAND:
         GS_process_sysex(size-2, expl);
-        expl = "GS " + expl;
+        if (csv) expl = "GS " + expl;
         break;
     case MIDI_SYSTEM_EXCLUSIVE_YAMAHA:
         XG_process_sysex(size-2, expl);
-        expl = "XG " + expl;
+        if (csv) expl = "XG " + expl;
         break;
     case MIDI_SYSTEM_EXCLUSIVE_NON_REALTIME:
         GM_process_sysex_non_realtime(size-2, expl);
-        expl = "SYSEX NR " + expl;
+        if (csv) expl = "SYSEX NR " + expl;
         break;
     case MIDI_SYSTEM_EXCLUSIVE_REALTIME:
         GM_process_sysex_realtime(size-2, expl);
-        expl = "SYSEX " + expl;
+        if (csv) expl = "SYSEX " + expl;
         break;
     case MIDI_SYSTEM_EXCLUSIVE_E_MU:
-        expl = "EMU";
+        if (csv) expl = "EMU";
         LOG(99, "Unsupported sysex vendor: E-Mu\n");
         break;
     case MIDI_SYSTEM_EXCLUSIVE_KORG:
-        expl = "KORG";
+        if (csv) expl = "KORG";
         LOG(99, "Unsupported sysex vendor: Korg\n");
         break;
     case MIDI_SYSTEM_EXCLUSIVE_CASIO:
-        expl = "CASIO";
+        if (csv) expl = "CASIO";
         LOG(99, "Unsupported sysex vendor: Casio\n");
         break;
     default:
@@ -910,7 +1029,7 @@ bool MIDIStream::process_sysex()
     size -= (offset() - offs);
     if (size)
     {
-        if (midi.get_csv(channel_no))
+        if (csv)
         {
             while (size--) CSV(channel_no, ", %d", pull_byte());
 //          if (midi.get_verbose()) {
@@ -925,10 +1044,11 @@ bool MIDIStream::process_sysex()
     return rv;
 }
 
+template<class policy_t>
 bool MIDIStream::process_meta()
 {
     bool rv = true;
-    std::string text;
+    std::string_view text;
     uint8_t meta = pull_byte();
     uint64_t size = pull_message();
     uint64_t offs = offset();
@@ -941,14 +1061,12 @@ bool MIDIStream::process_meta()
     case MIDI_TRACK_NAME:
     {
         auto& selections = midi.get_selections();
-        for (size_t i=0; i<size; ++i) {
-           toUTF8(text, pull_byte());
-        }
+        text = pull_text(size);
         if (!track_no) {
-            midi.set(AAX_TRACK_TITLE_STRING, text.c_str());
+            midi.set(AAX_TRACK_TITLE_STRING, text.data());
         }
-        MESSAGE(1, "%-7s %2i: %s\n", type_name[meta].c_str(), track_no, text.c_str());
-        CSV_TEXT(channel_no, csv_name[meta].c_str(), text.c_str());
+        MESSAGE(1, "%-7s %2i: %s\n", type_name[meta], track_no, text.data());
+        CSV_TEXT(channel_no, csv_name[meta], text.data());
         midi.channel(channel_no).set_track_name(text);
         if (std::find(selections.begin(), selections.end(), text) != selections.end()) {
             midi.set_track_active(track_no);
@@ -956,79 +1074,71 @@ bool MIDIStream::process_meta()
         break;
     }
     case MIDI_COPYRIGHT:
-        for (size_t i=0; i<size; ++i) {
-           toUTF8(text, pull_byte());
-        }
+        text = pull_text(size);
         if (!track_no) {
-            midi.set(AAX_SONG_COPYRIGHT_STRING, text.c_str());
+            midi.set(AAX_SONG_COPYRIGHT_STRING, text.data());
         }
-        MESSAGE(1, "%-10s: %s\n", type_name[meta].c_str(), text.c_str());
-        CSV_TEXT(channel_no, csv_name[meta].c_str(), text.c_str());
+        MESSAGE(1, "%-10s: %s\n", type_name[meta], text.data());
+        CSV_TEXT(channel_no, csv_name[meta], text.data());
         break;
     case MIDI_INSTRUMENT_NAME:
-        for (size_t i=0; i<size; ++i) {
-           toUTF8(text, pull_byte());
-        }
-        MESSAGE(1, "%-10s: %s\n", type_name[meta].c_str(), text.c_str());
-        CSV_TEXT(channel_no, csv_name[meta].c_str(), text.c_str());
+        text = pull_text(size);
+        MESSAGE(1, "%-10s: %s\n", type_name[meta], text.data());
+        CSV_TEXT(channel_no, csv_name[meta], text.data());
         break;
     case MIDI_TEXT:
-        for (size_t i=0; i<size; ++i) {
-            toUTF8(text, pull_byte());
-        }
-        if (text.front() == '\\') {
+    {
+        text = pull_text(size);
+        CSV_TEXT(channel_no, csv_name[meta], text.data());
+
+        char first = text.empty() ? 0 : text.front();
+        if (first == '\\') {
             midi.set_lyrics(true);
         }
         if (!midi.get_lyrics()) {
             DISPLAY(3, "Text: ");
             if (size > 64) DISPLAY(4, "\n");
-            DISPLAY(3, "%s\n", text.c_str());
+            DISPLAY(3, "%s\n", text.data());
         } else {
-            if (text.front() == '\\') {
+            // a backslash starts a new paragraph, a slash a new line
+            if (first == '\\') {
                 MESSAGE(1, "\n\n");
-                midi.set_lyrics(true);
-                text.front() = ' ';
-             }
-            else if (text.front() == '/') {
-            MESSAGE(1, "\n");
-                text.front() = ' ';
             }
-            MESSAGE(1, "%s", text.c_str()); FLUSH();
+            else if (first == '/') {
+                MESSAGE(1, "\n");
+            }
+            if (first == '\\' || first == '/') {
+                MESSAGE(1, " %s", text.data()+1); FLUSH();
+            } else {
+                MESSAGE(1, "%s", text.data()); FLUSH();
+            }
             if (size > 64) MESSAGE(1, "\n");
         }
-        CSV_TEXT(channel_no, csv_name[meta].c_str(), text.c_str());
         break;
+    }
     case MIDI_LYRICS:
         midi.set_lyrics(true);
-        for (size_t i=0; i<size; ++i) {
-           toUTF8(text, pull_byte());
-        }
-        MESSAGE(1, "%s", text.c_str()); FLUSH();
-        CSV_TEXT(channel_no, csv_name[meta].c_str(), text.c_str());
+        text = pull_text(size);
+        MESSAGE(1, "%s", text.data()); FLUSH();
+        CSV_TEXT(channel_no, csv_name[meta], text.data());
         break;
     case MIDI_MARKER:
-        for (size_t i=0; i<size; ++i) {
-           toUTF8(text, pull_byte());
-        }
+        text = pull_text(size);
         if (!track_no) {
-            midi.set(AAX_TRACK_TITLE_UPDATE, text.c_str());
+            midi.set(AAX_TRACK_TITLE_UPDATE, text.data());
         }
-        MESSAGE(1, "%s: %s\n", type_name[meta].c_str(), text.c_str());
-        CSV_TEXT(channel_no, csv_name[meta].c_str(), text.c_str());
+        MESSAGE(1, "%s: %s\n", type_name[meta], text.data());
+        CSV_TEXT(channel_no, csv_name[meta], text.data());
         break;
     case MIDI_CUE_POINT:
-        for (size_t i=0; i<size; ++i) {
-           toUTF8(text, pull_byte());
-        }
-        MESSAGE(1, "%s: %s", type_name[meta].c_str(), text.c_str());
-        CSV_TEXT(channel_no, csv_name[meta].c_str(), text.c_str());
+        text = pull_text(size);
+        MESSAGE(1, "%s: %s", type_name[meta], text.data());
+        CSV_TEXT(channel_no, csv_name[meta], text.data());
         break;
     case MIDI_DEVICE_NAME:
-        for (size_t i=0; i<size; ++i) {
-           toUTF8(text, pull_byte());
-        }
-        MESSAGE(1, "%s", text.c_str());
-        CSV_TEXT(channel_no, csv_name[meta].c_str(), text.c_str());
+        text = pull_text(size);
+        MESSAGE(1, "%s", text.data());
+        CSV_TEXT(channel_no, csv_name[meta], text.data());
         break;
     case MIDI_CHANNEL_PREFIX:
         c = pull_byte();
@@ -1056,7 +1166,7 @@ bool MIDIStream::process_meta()
     {
         uint8_t mm = pull_byte();
         uint8_t ll = pull_byte();
-        CSV(channel_no, "%s, %d\n", csv_name[meta].c_str(), (mm << 8) | ll);
+        CSV(channel_no, "%s, %d\n", csv_name[meta], (mm << 8) | ll);
         break;
     }
     case MIDI_TIME_SIGNATURE:
@@ -1103,22 +1213,16 @@ bool MIDIStream::process_meta()
         break;
     }
     case MIDI_SEQUENCERSPECIFICMETAEVENT:
-        for (size_t i=0; i<size; ++i) {
-           text += pull_byte();
-        }
         CSV(channel_no, "%s, %lu", "Sequencer_specific", size);
         for (size_t i=0; i<size; ++i) {
-            CSV(channel_no, ", %d", text[i]);
+            CSV(channel_no, ", %d", pull_byte());
         }
         CSV(channel_no, "\n");
         break;
     default:        // unsupported
-        for (size_t i=0; i<size; ++i) {
-           text += pull_byte();
-        }
         CSV(channel_no, "%s, %d, %lu", "Unknown_meta_event", meta, size);
         for (size_t i=0; i<size; ++i) {
-            CSV(channel_no, ", %d", text[i]);
+            CSV(channel_no, ", %d", pull_byte());
         }
         CSV(channel_no, "\n");
         LOG(99, "LOG: Unknown.meta.event: %i (0x%x)\n", meta, meta);
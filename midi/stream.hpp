@@ -23,11 +23,13 @@
 #pragma once
 
 #include <map>
-#include <random>
+#include <bitset>
+#include <string_view>
 
 #include <aax/byte_stream.hpp>
 
 #include <midi/shared.hpp>
+#include <midi/sysex.hpp>
 
 #include "base/types.h"
 
@@ -38,12 +40,6 @@ namespace aeonwave
 
 class MIDIDriver;
 
-struct param_t
-{
-   uint8_t coarse;
-   uint8_t fine;
-};
-
 class MIDIEnsemble;
 
 class MIDIStream : public byte_stream
@@ -52,6 +48,7 @@ public:
     MIDIStream() = default;
 
     MIDIStream(MIDIDriver& ptr, byte_stream& stream, size_t len,  uint16_t track);
+    MIDIStream(MIDIDriver& ptr, byte_stream& stream, uint16_t track);
     MIDIStream(const MIDIStream&) = default;
 
     virtual ~MIDIStream() = default;
@@ -59,14 +56,28 @@ public:
     void rewind();
     bool process(uint64_t, uint32_t&, uint32_t&);
 
+    // process a single, complete, message without a delta-time
+    bool process(uint8_t *message, size_t len);
+
+    // process the event which starts at offs, used by the song timeline
+    template<class policy_t> bool dispatch(size_t offs);
+
+    // process a complete message, with its status byte, which was copied
+    // from the track by the look-ahead parser
+    bool dispatch(const uint8_t *message, size_t len);
+
+    inline uint64_t get_timestamp_parts() { return timestamp_parts; }
+    inline uint8_t get_running_status() { return previous; }
+
     inline uint8_t get_track_no() { return track_no; }
     inline uint16_t get_channel_no() { return channel_no; }
-    inline const std::string& get_channel_name() { return name; }
+    inline std::string_view get_channel_name() { return name; }
 
     MIDIDriver& midi;
 private:
     float cents2pitch(float p, uint8_t channel);
-    float cents2modulation(float p, uint8_t channel);
+    float pressure2pitch(uint8_t value, uint8_t channel);
+    float modulation2pitch(uint8_t value, uint8_t channel);
 
     // https://stackoverflow.com/questions/4059775/convert-iso-8859-1-strings-to-utf-8-in-c-c
     inline void toUTF8(std::string& text, uint8_t c) {
@@ -80,12 +91,12 @@ private:
     }
 
     uint32_t pull_message();
+    std::string_view pull_text(size_t size);
+    bool process_event();
     bool registered_param(uint8_t, uint8_t, uint8_t, const char*);
-    bool registered_param_3d(uint8_t, uint8_t, uint8_t);
-
-    std::mt19937 m_mt;
 
-    std::string name;
+    // the name of the patch in the instrument or drum set
+    std::string_view name;
 
     uint8_t mode = 0;
     uint8_t track_no = 0;
@@ -99,28 +110,8 @@ private:
     bool polyphony = true;
     bool omni = true;
 
-    bool pitch_bend_enabled = true;
-    bool channel_pressure_enabled = true;
-    bool program_change_enabled = true;
-    bool control_change_enabled = true;
-    bool poly_pressure_enabled = true;
-    bool note_message_enabled = true;
-    bool rpn_enabled = true;
-    bool nrpn_enabled = true;
-    bool modulation_enabled = true;
-    bool volume_enabled = true;
-    bool pan_enabled = true;
-    bool expression_enabled = true;
-    bool hold1_enabled = true;
-    bool sustain_enabled = true;
-    bool soft_enabled = true;
-    bool bank_select_enabled = true;
-    bool bank_select_lsb_enabled = true;
-    bool equalizer_enabled = true;
-
-    bool rpn = true;
-    bool registered = false;
-    uint8_t prev_controller = 0;
+    // the receive switches, indexed by SWITCH_*, all on by default
+    std::bitset<SWITCH_MAX> enabled = std::bitset<SWITCH_MAX>().set();
 
     uint8_t key_range_low = 0;
     uint8_t key_range_high = 127;
@@ -130,27 +121,21 @@ private:
         24.0f, 25.0f, 29.97f, 30.0f
     };
 
-    uint16_t msb_type = 0;
-    uint16_t lsb_type = 0;
-    std::map<uint16_t,struct param_t> param = {
-        {0, { 2, 0 }}, {1, { 0x40, 0 }}, {2, { 0x20, 0 }}, {3, { 0, 0 }},
-        {4, { 0, 0 }}, {5, { 1, 0 }}, {6, { 0, 0 }}
-    };
-    std::map<uint16_t,struct param_t> param_3d;
-
-    const std::string type_name[10] = {
+    static constexpr const char* type_name[10] = {
         "Sequencey", "Text", "Copyright", "Title", "Instrument", "Lyrics",
         "Marker", "Cue", "Program", "Device"
     };
-    const std::string csv_name[10] = {
+    static constexpr const char* csv_name[10] = {
         "Sequence_number", "Text_t", "Copyright_t", "Title_t",
         "Instrument_name_t", "Lyrics_t", "Marker_t", "Cue_point_t",
         "Program_name_t", "Device_name_t"
     };
 
-    bool process_control(uint8_t);
-    bool process_meta();
-    bool process_sysex();
+    template<class policy_t> void process_events(uint64_t);
+    template<class policy_t> bool process_event();
+    template<class policy_t> bool process_control(uint8_t);
+    template<class policy_t> bool process_meta();
+    template<class policy_t> bool process_sysex(uint64_t);
 
     std::string GM_initialize(uint8_t mode);
     bool GM_process_sysex_realtime(uint64_t, std::string&);
@@ -164,14 +149,25 @@ private:
     bool GS_sysex_equalizer(uint8_t part_no, uint8_t addr, uint8_t value);
     bool GS_sysex_insertion(uint8_t part_no, uint8_t addr, uint16_t type, std::string& expl);
     bool GS_sysex_modulation(uint8_t part_no, uint8_t addr, uint8_t value, std::string& expl);
-    bool GS_sysex_part(uint8_t part_no, uint8_t addr, uint8_t value, std::string& expl);
+    static const sysex_table_t GS_part_param;
+    void GS_sysex_flush();
 
     void XG_initialize();
     bool XG_process_sysex(uint64_t, std::string&);
+    static const sysex_table_t XG_part_param;
     uint8_t XG_part_no[32] = {
         0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
        17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31
     };
+
+    bool XG_sysex_bulk_dump(uint64_t size, uint64_t offs, std::string& expl);
+    void XG_sysex_flush();
+
+    uint8_t sysex_pull(const sysex_table_t& table, uint8_t addr,
+                       uint8_t value, uint8_t *data);
+    bool sysex_part(const sysex_table_t& table, uint8_t block,
+                    uint8_t part_no, uint8_t addr, const uint8_t *data,
+                    std::string& expl);
 };
 
 } // namespace aeonwave
@@ -0,0 +1,311 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave MIDI library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#include <cstdint>
+#include <algorithm>
+#include <string>
+#include <iterator>
+
+#include <midi/ensemble.hpp>
+#include <midi/stream.hpp>
+#include <midi/driver.hpp>
+
+using namespace aax;
+using policy_t = MIDIPolicyRuntime;
+
+#define SYSEX_PAGE_SIZE		(128*128)
+
+MIDISysexImage::MIDISysexImage(std::initializer_list<uint8_t> p)
+    : pages(p)
+{
+    page_no.fill(-1);
+    for (size_t i=0; i<pages.size(); ++i) {
+        page_no[pages[i] & 0x7f] = i;
+    }
+    image.resize(pages.size()*SYSEX_PAGE_SIZE);
+    dirty.resize(image.size()/64);
+    dirty_first = image.size();
+}
+
+size_t
+MIDISysexImage::copy(size_t offs, const uint8_t *data, size_t len,
+                     bool mark_dirty)
+{
+    size_t rv = 0;
+    for (size_t i=0; i<len; ++i, ++offs)
+    {
+        uint8_t value = data[i] & 0x7f;
+        bool changed = (image[offs] != value);
+        if (mark_dirty)
+        {
+            dirty[offs >> 6] |= (1ULL << (offs & 0x3f));
+            dirty_first = _MIN(dirty_first, offs);
+            dirty_last = _MAX(dirty_last, offs+1);
+        }
+        if (changed)
+        {
+            image[offs] = value;
+            ++rv;
+        }
+    }
+    return rv;
+}
+
+// Consecutive bytes go to consecutive addresses, the low address byte
+// carries into the middle address byte but never into the next page.
+size_t
+MIDISysexImage::write(uint8_t high, uint8_t mid, uint8_t low,
+                      const uint8_t *data, size_t len, bool mark_dirty)
+{
+    if (!contains(high)) return 0;
+
+    size_t offs = (mid & 0x7f) << 7 | (low & 0x7f);
+    len = _MIN(len, SYSEX_PAGE_SIZE - offs);
+    offs += page_no[high & 0x7f]*SYSEX_PAGE_SIZE;
+
+    return copy(offs, data, len, mark_dirty);
+}
+
+const uint8_t*
+MIDISysexImage::get(uint8_t high, uint8_t mid, uint8_t low) const
+{
+    if (!contains(high)) return nullptr;
+
+    size_t offs = page_no[high & 0x7f]*SYSEX_PAGE_SIZE;
+    offs += (mid & 0x7f) << 7 | (low & 0x7f);
+    return image.data() + offs;
+}
+
+void
+MIDISysexImage::clear()
+{
+    std::fill(image.begin(), image.end(), 0);
+    std::fill(dirty.begin(), dirty.end(), 0);
+    dirty_first = image.size();
+    dirty_last = 0;
+}
+
+/*
+ * Reads the data bytes of the part parameter at addr which are not read
+ * yet, value is the first data byte. Returns the number of data bytes.
+ */
+uint8_t
+MIDIStream::sysex_pull(const sysex_table_t& table, uint8_t addr,
+                       uint8_t value, uint8_t *data)
+{
+    const sysex_param_t& param = table[addr & 0x7f];
+
+    data[0] = value;
+    for (uint8_t i=1; i<param.size; ++i)
+    {
+        data[i] = pull_byte();
+        CSV(channel_no, ", %d", data[i]);
+    }
+    return param.size;
+}
+
+/*
+ * Performs one part parameter of a GS or XG parameter change message.
+ * block is the middle address byte, addr the low address byte and
+ * data the data bytes of the parameter.
+ */
+bool
+MIDIStream::sysex_part(const sysex_table_t& table, uint8_t block,
+                       uint8_t part_no, uint8_t addr, const uint8_t *data,
+                       std::string& expl)
+{
+    const sysex_param_t& param = table[addr & 0x7f];
+    auto& channel = midi.channel(part_no);
+    bool csv = midi.get_csv(channel_no);
+    int32_t value = data[0];
+    bool rv = true;
+
+    if (param.size == 2 && param.action != SYSEX_TONE_NUMBER) {
+        value = (value & 0xf) << 4 | (data[1] & 0xf);
+    }
+
+    if (param.flag && param.action != SYSEX_SWITCH && !enabled[param.flag])
+    {
+        if (csv) expl = std::string(param.name) + ": " + std::to_string(value);
+        return rv;
+    }
+
+    float val = param.scale*value + param.offset;
+    switch(param.action)
+    {
+    case SYSEX_SWITCH:
+        enabled[param.flag] = value;
+        break;
+    case SYSEX_TONE_NUMBER: // CC#00: MIDI_BANK_SELECT MSB
+    {
+        bool prev = channel.is_drums();
+        bool drums = (part_no == MIDI_DRUMS_CHANNEL);
+        if (prev != drums)
+        {
+            channel.set_drums(drums);
+            const char* type = midi.get_channel_type(part_no);
+            MESSAGE(3, "Set part %i to %s\n", part_no, type);
+        }
+
+        bank_no = value << 7;
+        program_no = data[1];
+        try {
+            midi.new_channel(part_no, bank_no, program_no, true);
+            if (midi.is_drums(part_no))
+            {
+                auto& frames = midi.get_configurations();
+                auto it = frames.find(program_no);
+                if (it != frames.end()) {
+                    name = it->second[0].name;
+                }
+            }
+            else
+            {
+                auto& inst = midi.get_instrument(bank_no, program_no);
+                if (inst.size()) name = inst[0].name;
+            }
+        } catch(const std::invalid_argument& e) {
+            ERROR("Error: " << e.what());
+        }
+        break;
+    }
+    case SYSEX_BANK_SELECT_MSB:
+        bank_no = value << 7;
+        break;
+    case SYSEX_BANK_SELECT_LSB:
+        bank_no += value;
+        break;
+    case SYSEX_PROGRAM_NUMBER:
+        program_no = value;
+        try {
+            midi.new_channel(part_no, bank_no, program_no, true);
+        } catch(const std::invalid_argument& e) {
+            ERROR("Error: " << e.what());
+        }
+        break;
+    case SYSEX_RECV_CHANNEL:
+        if (block < std::size(XG_part_no)) XG_part_no[block] = value;
+        break;
+    case SYSEX_POLY_MODE:
+        midi.all_notes_off(part_no);
+        if (value == 0) {
+            mode = MIDI_MONOPHONIC;
+            channel.set_monophonic(true);
+        } else {
+            channel.set_monophonic(false);
+            mode = MIDI_POLYPHONIC;
+        }
+        break;
+    case SYSEX_DRUMS:
+    {
+        bool drums = value ? true : false;
+        channel.set_drums(drums);
+        const char* type = midi.get_channel_type(part_no);
+        MESSAGE(3, "Set part %i to %s\n", part_no, type);
+        break;
+    }
+    case SYSEX_PORTAMENTO:
+        channel.set_pitch_slide_state(value >= 0x40);
+        break;
+    case SYSEX_KEY_SHIFT:
+        channel.set_tuning_coarse(val);
+        break;
+    case SYSEX_TUNING_OFFSET:
+        channel.set_tuning_offset(val);
+        break;
+    case SYSEX_TUNING_FINE:
+        channel.set_tuning_fine(val);
+        break;
+    case SYSEX_SCALE_TUNING:
+        channel.set_tuning_fine(val, addr - param.first);
+        break;
+    case SYSEX_DETUNE:
+        channel.set_celeste_depth(cents2pitch(param.scale*int8_t(value), part_no));
+        break;
+    case SYSEX_GAIN:
+        channel.set_gain(aax::math::ln(val));
+        break;
+    case SYSEX_PAN:
+    case SYSEX_PAN_RANDOM:
+        if (mode != MIDI_MONOPHONIC)
+        {
+            if (param.action == SYSEX_PAN_RANDOM && value == 0) {
+                std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
+                channel.set_pan(dis(midi.get_random()));
+            } else {
+                channel.set_pan(val);
+            }
+        }
+        break;
+    case SYSEX_KEY_RANGE_LOW:
+        key_range_low = value;
+        break;
+    case SYSEX_KEY_RANGE_HIGH:
+        key_range_high = value;
+        break;
+    case SYSEX_CHORUS_SEND:
+        midi.set_chorus_level(part_no, val);
+        break;
+    case SYSEX_REVERB_SEND:
+        midi.set_reverb_level(part_no, val);
+        break;
+    case SYSEX_VIBRATO_RATE:
+        channel.set_vibrato_rate(val);
+        break;
+    case SYSEX_VIBRATO_DEPTH:
+        channel.set_vibrato_depth(val);
+        break;
+    case SYSEX_VIBRATO_DELAY:
+        channel.set_vibrato_delay(val);
+        break;
+    case SYSEX_FILTER_CUTOFF:
+        // Positive settings of Cutoff Freq will raise the cutoff frequency.
+        // Negative settings will lower the cutoff frequency.
+        if (val < 1.0f) val = 0.5f + 0.5f*val;
+        channel.set_filter_cutoff(val);
+        break;
+    case SYSEX_FILTER_RESONANCE:
+        channel.set_filter_resonance(val);
+        break;
+    case SYSEX_ATTACK_TIME:
+        channel.set_attack_time(value);
+        break;
+    case SYSEX_DECAY_TIME:
+        channel.set_decay_time(value);
+        break;
+    case SYSEX_RELEASE_TIME:
+        channel.set_release_time(value);
+        break;
+    case SYSEX_PITCH_DEPTH:
+        channel.set_pitch_depth(val);
+        break;
+    case SYSEX_UNSUPPORTED:
+        LOG(99, "LOG: Unsupported sysex part parameter: %s\n", param.name);
+        break;
+    case SYSEX_UNKNOWN:
+    default:
+        LOG(99, "LOG: Unsupported sysex part parameter: 0x%02x (%d)\n",
+                addr, addr);
+        rv = false;
+        break;
+    }
+
+    // the explanation is only needed for the CSV output
+    if (csv)
+    {
+        if (param.action == SYSEX_UNKNOWN) expl = "Unknown " + std::to_string(addr);
+        else if (param.action == SYSEX_UNSUPPORTED) {
+            expl = "Unsupported " + std::string(param.name);
+        }
+        else expl = param.name;
+        expl += ": " + std::to_string(value);
+    }
+
+    return rv;
+}
@@ -0,0 +1,181 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave MIDI library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include <array>
+#include <vector>
+#include <initializer_list>
+
+namespace aeonwave
+{
+
+class MIDIStream;
+
+enum {
+    SYSEX_UNKNOWN = 0,
+    SYSEX_UNSUPPORTED,
+    SYSEX_SWITCH,
+    SYSEX_TONE_NUMBER,
+    SYSEX_BANK_SELECT_MSB,
+    SYSEX_BANK_SELECT_LSB,
+    SYSEX_PROGRAM_NUMBER,
+    SYSEX_RECV_CHANNEL,
+    SYSEX_POLY_MODE,
+    SYSEX_DRUMS,
+    SYSEX_PORTAMENTO,
+    SYSEX_KEY_SHIFT,
+    SYSEX_TUNING_OFFSET,
+    SYSEX_TUNING_FINE,
+    SYSEX_SCALE_TUNING,
+    SYSEX_DETUNE,
+    SYSEX_GAIN,
+    SYSEX_PAN,
+    SYSEX_PAN_RANDOM,
+    SYSEX_KEY_RANGE_LOW,
+    SYSEX_KEY_RANGE_HIGH,
+    SYSEX_CHORUS_SEND,
+    SYSEX_REVERB_SEND,
+    SYSEX_VIBRATO_RATE,
+    SYSEX_VIBRATO_DEPTH,
+    SYSEX_VIBRATO_DELAY,
+    SYSEX_FILTER_CUTOFF,
+    SYSEX_FILTER_RESONANCE,
+    SYSEX_ATTACK_TIME,
+    SYSEX_DECAY_TIME,
+    SYSEX_RELEASE_TIME,
+    SYSEX_PITCH_DEPTH
+};
+
+// The receive switches of a part, bit numbers in MIDIStream::enabled.
+enum {
+    SWITCH_NONE = 0,
+    SWITCH_PITCH_BEND,
+    SWITCH_CHANNEL_PRESSURE,
+    SWITCH_PROGRAM_CHANGE,
+    SWITCH_CONTROL_CHANGE,
+    SWITCH_POLY_PRESSURE,
+    SWITCH_NOTE_MESSAGE,
+    SWITCH_RPN,
+    SWITCH_NRPN,
+    SWITCH_MODULATION,
+    SWITCH_VOLUME,
+    SWITCH_PAN,
+    SWITCH_EXPRESSION,
+    SWITCH_HOLD1,
+    SWITCH_SUSTAIN,
+    SWITCH_SOFT,
+    SWITCH_BANK_SELECT,
+    SWITCH_BANK_SELECT_LSB,
+    SWITCH_EQUALIZER,
+
+    SWITCH_MAX
+};
+
+/*
+ * One row of a sysex parameter address map.
+ *
+ * The row covers the addresses first up to and including last. The value
+ * is converted to scale*value + offset before it is handed to the action.
+ * size is the number of data bytes of the parameter, two bytes are sent
+ * as two nibbles, high nibble first, except for the tone number which
+ * is sent as the bank number followed by the program number.
+ * flag is the enable switch which is set by SYSEX_SWITCH, or, for all
+ * other actions, the switch which has to be set for the action to be
+ * performed. SWITCH_NONE means the action is always performed.
+ */
+struct sysex_param_t
+{
+    uint8_t first = 0;
+    uint8_t last = 0;
+    const char *name = nullptr;
+    uint8_t action = SYSEX_UNKNOWN;
+    uint8_t size = 1;
+    float scale = 1.0f;
+    float offset = 0.0f;
+    uint8_t flag = SWITCH_NONE;
+};
+
+// indexed by the low address byte
+using sysex_table_t = std::array<sysex_param_t, 128>;
+
+template<size_t N>
+constexpr sysex_table_t make_sysex_table(const sysex_param_t (&rows)[N])
+{
+    sysex_table_t table{};
+    for (size_t i=0; i<N; ++i) {
+        for (size_t addr=rows[i].first; addr<=rows[i].last; ++addr) {
+            table[addr] = rows[i];
+        }
+    }
+    return table;
+}
+
+/*
+ * The parameter memory of a GS or XG sound module.
+ *
+ * Only the address pages (high address bytes) given to the constructor
+ * are stored, each as a flat block of 128x128 bytes indexed by the middle
+ * and the low address byte.
+ *
+ * The image does not see the channel messages which change the same
+ * settings, so a bulk dump marks every byte it carries as dirty and all
+ * of them get applied, even the ones which did not change.
+ */
+class MIDISysexImage
+{
+public:
+    MIDISysexImage(std::initializer_list<uint8_t> pages);
+    ~MIDISysexImage() = default;
+
+    inline bool contains(uint8_t high) const {
+        return page_no[high & 0x7f] >= 0;
+    }
+
+    // Returns the number of bytes which changed, mark_dirty marks all
+    // bytes which were written.
+    size_t write(uint8_t high, uint8_t mid, uint8_t low,
+                 const uint8_t *data, size_t len, bool mark_dirty);
+
+    const uint8_t* get(uint8_t high, uint8_t mid, uint8_t low) const;
+
+    // Calls fn(high, mid, low) for every dirty byte and clears its flag.
+    template<typename F>
+    void flush(F fn)
+    {
+        for (size_t i=dirty_first; i<dirty_last; ++i)
+        {
+            if (dirty[i >> 6] & (1ULL << (i & 0x3f)))
+            {
+                dirty[i >> 6] &= ~(1ULL << (i & 0x3f));
+                fn(pages[i >> 14], (i >> 7) & 0x7f, i & 0x7f);
+            }
+        }
+        dirty_first = image.size();
+        dirty_last = 0;
+    }
+
+    void clear();
+
+private:
+    size_t copy(size_t offs, const uint8_t *data, size_t len, bool mark_dirty);
+
+    std::array<int8_t, 128> page_no;
+    std::vector<uint8_t> pages;
+    std::vector<uint8_t> image;
+    std::vector<uint64_t> dirty;
+    size_t dirty_first = 0;
+    size_t dirty_last = 0;
+};
+
+} // namespace aeonwave
+
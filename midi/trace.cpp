@@ -0,0 +1,207 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave MIDI library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#include <cstring>
+
+#include <midi/trace.hpp>
+
+using namespace aeonwave;
+
+MIDITrace&
+MIDITrace::instance()
+{
+    static MIDITrace trace;
+    return trace;
+}
+
+bool
+MIDITrace::open(const char *filename)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (fp) return false;
+
+    fp = fopen(filename, "w");
+    if (!fp) return false;
+
+    fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    named.clear();
+    first = true;
+    epoch = clock::now();
+
+    active = true;
+    thread = std::thread(&MIDITrace::writer, this);
+
+    return true;
+}
+
+void
+MIDITrace::close()
+{
+    if (!active) return;
+
+    active = false;
+    thread.join();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    flush();
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
+    fp = nullptr;
+}
+
+// Every thread registers its ring the first time it records an event,
+// the ring stays registered after the thread exits so nothing is lost.
+MIDITrace::thread_ring&
+MIDITrace::local()
+{
+    thread_local std::shared_ptr<thread_ring> ring;
+    if (!ring)
+    {
+        ring = std::make_shared<thread_ring>();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        ring->tid = rings.size()+1;
+        rings.push_back(ring);
+    }
+    return *ring;
+}
+
+void
+MIDITrace::record(trace_event_t& e, clock::time_point start, int32_t channel,
+                  const char *detail)
+{
+    thread_ring& ring = local();
+
+    e.ts_us = std::chrono::duration_cast<std::chrono::microseconds>(start - epoch).count();
+    e.channel = channel;
+    e.tid = (channel >= 0) ? MIDI_TRACE_CHANNEL_TID+channel : ring.tid;
+    if (detail) {
+        strncpy(e.detail, detail, MIDI_TRACE_DETAIL_SIZE-1);
+        e.detail[MIDI_TRACE_DETAIL_SIZE-1] = 0;
+    } else {
+        e.detail[0] = 0;
+    }
+
+    if (!ring.events.push(e)) {
+        no_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void
+MIDITrace::instant(const char *name, const char *cat, int32_t channel,
+                   const char *arg_name, int64_t value, const char *detail)
+{
+    if (!enabled()) return;
+
+    trace_event_t e;
+    e.name = name;
+    e.cat = cat;
+    e.arg_name = arg_name;
+    e.value = value;
+    e.dur_us = 0;
+    e.ph = 'i';
+    record(e, clock::now(), channel, detail);
+}
+
+void
+MIDITrace::span(const char *name, const char *cat, clock::time_point start,
+                int32_t channel, const char *arg_name, int64_t value,
+                const char *detail)
+{
+    if (!enabled()) return;
+
+    trace_event_t e;
+    e.name = name;
+    e.cat = cat;
+    e.arg_name = arg_name;
+    e.value = value;
+    e.dur_us = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count();
+    e.ph = 'X';
+    record(e, start, channel, detail);
+}
+
+void
+MIDITrace::writer()
+{
+    while (active)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        std::lock_guard<std::mutex> lock(mutex);
+        flush();
+    }
+}
+
+// Called with the mutex locked.
+void
+MIDITrace::flush()
+{
+    trace_event_t e;
+    for (auto& it : rings)
+    {
+        while (it->events.pop(e)) {
+            write(e);
+        }
+    }
+    fflush(fp);
+}
+
+void
+MIDITrace::write(const trace_event_t& e)
+{
+    if (!first) fprintf(fp, ",\n");
+    first = false;
+
+    // name the timeline the first time it is used
+    if (named.insert(e.tid).second)
+    {
+        fprintf(fp, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                    "\"tid\":%i,\"args\":{\"name\":\"", e.tid);
+        if (e.tid >= MIDI_TRACE_CHANNEL_TID) {
+            fprintf(fp, "channel %i", e.tid-MIDI_TRACE_CHANNEL_TID);
+        } else {
+            fprintf(fp, "thread %i", e.tid);
+        }
+        fprintf(fp, "\"}},\n");
+    }
+
+    fprintf(fp, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"pid\":1,"
+                "\"tid\":%i,\"ts\":%lu",
+                e.name, e.cat, e.ph, e.tid, (unsigned long)e.ts_us);
+    if (e.ph == 'X') {
+        fprintf(fp, ",\"dur\":%u", e.dur_us);
+    } else {
+        fprintf(fp, ",\"s\":\"t\"");
+    }
+
+    fprintf(fp, ",\"args\":{");
+    const char *sep = "";
+    if (e.channel >= 0)
+    {
+        fprintf(fp, "\"channel\":%i", e.channel);
+        sep = ",";
+    }
+    if (e.arg_name)
+    {
+        fprintf(fp, "%s\"%s\":%li", sep, e.arg_name, (long)e.value);
+        sep = ",";
+    }
+    if (e.detail[0])
+    {
+        fprintf(fp, "%s\"detail\":\"", sep);
+        for (const char *p = e.detail; *p; ++p)
+        {
+            if (*p == '"' || *p == '\\') fputc('\\', fp);
+            if ((unsigned char)*p >= 0x20) fputc(*p, fp);
+        }
+        fputc('"', fp);
+    }
+    fprintf(fp, "}}");
+}
@@ -0,0 +1,138 @@
+/*
+ * SPDX-FileCopyrightText: Copyright © 2024 by Erik Hofman.
+ * SPDX-FileCopyrightText: Copyright © 2024 by Adalin B.V.
+ *
+ * Package Name: AeonWave MIDI library.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+ */
+
+#pragma once
+
+#include <cstdio>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <set>
+
+#include <midi/ring_buffer.hpp>
+
+namespace aeonwave
+{
+
+#define MIDI_TRACE_DETAIL_SIZE		32
+#define MIDI_TRACE_CHANNEL_TID		1000
+
+struct trace_event_t
+{
+    const char *name;
+    const char *cat;
+    const char *arg_name;
+    uint64_t ts_us;
+    uint32_t dur_us;
+    int32_t tid;
+    int32_t channel;
+    int64_t value;
+    char ph;
+    char detail[MIDI_TRACE_DETAIL_SIZE];
+};
+
+/*
+ * Writes a Chrome trace (JSON) file which can be loaded in chrome://tracing
+ * or https://ui.perfetto.dev
+ *
+ * Every thread which records events gets its own lock-free ring buffer
+ * so recording never blocks. A writer thread periodically drains the
+ * rings and formats the events, away from the sequencer thread.
+ * Names, categories and argument names must be string literals.
+ *
+ * Channel events are recorded on a timeline of their own per channel,
+ * all other events on the timeline of the thread which recorded them.
+ */
+class MIDITrace
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    static MIDITrace& instance();
+
+    ~MIDITrace() { close(); }
+
+    bool open(const char *filename);
+    void close();
+
+    static inline bool enabled() {
+        return instance().active.load(std::memory_order_relaxed);
+    }
+
+    void instant(const char *name, const char *cat, int32_t channel = -1,
+                 const char *arg_name = nullptr, int64_t value = 0,
+                 const char *detail = nullptr);
+    void span(const char *name, const char *cat, clock::time_point start,
+              int32_t channel = -1, const char *arg_name = nullptr,
+              int64_t value = 0, const char *detail = nullptr);
+
+    uint32_t get_no_dropped() { return no_dropped; }
+
+private:
+    MIDITrace() = default;
+
+    struct thread_ring
+    {
+        ring_buffer<trace_event_t, 1024> events;
+        int32_t tid;
+    };
+
+    thread_ring& local();
+    void record(trace_event_t& e, clock::time_point start, int32_t channel,
+                const char *detail);
+    void writer();
+    void flush();
+    void write(const trace_event_t& e);
+
+    std::mutex mutex;
+    std::vector<std::shared_ptr<thread_ring>> rings;
+    std::thread thread;
+    std::atomic<bool> active{false};
+    std::atomic<uint32_t> no_dropped{0};
+
+    FILE *fp = nullptr;
+    std::set<int32_t> named;
+    bool first = true;
+    clock::time_point epoch;
+};
+
+// Records the time spent in the current scope as one span.
+class trace_scope
+{
+public:
+    trace_scope(const char *n, const char *c, int32_t ch = -1,
+                const char *d = nullptr, bool e = true)
+        : name(n), cat(c), detail(d), channel(ch),
+          enabled(e && MIDITrace::enabled())
+    {
+        if (enabled) start = MIDITrace::clock::now();
+    }
+
+    ~trace_scope() {
+        if (enabled) {
+            MIDITrace::instance().span(name, cat, start, channel,
+                                       nullptr, 0, detail);
+        }
+    }
+
+private:
+    const char *name;
+    const char *cat;
+    const char *detail;
+    int32_t channel;
+    bool enabled;
+    MIDITrace::clock::time_point start;
+};
+
+} // namespace aeonwave
+
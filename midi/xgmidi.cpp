@@ -153,13 +153,14 @@ static XGMIDI_effect_t XGMIDI_EQ_types[XGMIDI_MAX_EQ_TYPES] = {
 }
 
 using namespace aax;
+using policy_t = MIDIPolicyRuntime;
 
 void MIDIStream::XG_initialize()
 {
     float val = 40.0f/127.0f;
     for (auto& it : midi.get_channels())
     {
-        midi.process(it.first, MIDI_NOTE_OFF, 0, 0, true);
+        midi.all_notes_off(it.first);
 
         midi.set_reverb("XG/hall1", XGMIDI_REVERB_HALL1, XG);
         midi.set_reverb_level(it.first, val);
@@ -179,6 +180,8 @@ void MIDIStream::XG_initialize()
 
 bool MIDIStream::XG_process_sysex(uint64_t size, std::string& expl)
 {
+    // the explanation is only needed for the CSV output
+    bool csv = midi.get_csv(channel_no);
     bool rv = false;
     uint64_t offs = offset();
     uint8_t type;
@@ -198,7 +201,7 @@ bool MIDIStream::XG_process_sysex(uint64_t size, std::string& expl)
     switch (type & 0xF0)
     {
     case XGMIDI_BULK_DUMP:
-        expl = "BULK_DUMP";
+        rv = XG_sysex_bulk_dump(size, offs, expl);
         break;
     case XGMIDI_PARAMETER_CHANGE:
         byte = pull_byte();
@@ -213,8 +216,11 @@ bool MIDIStream::XG_process_sysex(uint64_t size, std::string& expl)
             uint32_t value = pull_byte();
             uint16_t addr = addr_mid << 8 | addr_low;
             uint16_t part_no = XG_part_no[addr_mid];
-            auto& channel = midi.channel(part_no);
             CSV(part_no, ", %d, %d, %d, %d", addr_high, addr_mid, addr_low, value);
+
+            uint8_t data[2] = { uint8_t(value), 0 };
+            auto& image = midi.get_sysex_image(XG);
+
             switch (addr_high)
             {
             case XGMIDI_SYSTEM:
@@ -758,7 +764,7 @@ bool MIDIStream::XG_process_sysex(uint64_t size, std::string& expl)
                                 type, type);
                         break;
                     }
-                    expl += " VARIATION";
+                    if (csv) expl += " VARIATION";
                     break;
                 }
                 case XGMIDI_VARIATION_PARAMETER1:
@@ -837,222 +843,11 @@ bool MIDIStream::XG_process_sysex(uint64_t size, std::string& expl)
                 LOG(99, "LOG: Unsupported XG sysex type: Multi EQ\n");
                 break;
             case XGMIDI_MULTI_PART:
-            { // http://www.studio4all.de/htmle/main92.html#xgprgxgpart02a01
-                switch (addr_low)
-                {
-                case XGMIDI_BANK_SELECT_MSB:// 0-127
-                    expl = "BANK_SELECT_MSB";
-                    bank_no = value << 7;
-                    break;
-                case XGMIDI_BANK_SELECT_LSB: // 0-127
-                    expl = "BANK_SELECT_LSB";
-                    bank_no += value;
-                    break;
-                case XGMIDI_PROGRAM_NUMBER: // 1-128
-                    expl = "PROGRAM_NUMBER";
-                    try {
-                        midi.new_channel(channel_no, bank_no, program_no);
-                    } catch(const std::invalid_argument& e) {
-                        ERROR("Error: " << e.what());
-                    }
-                    break;
-                case XGMIDI_RECV_CHANNEL:
-                    expl = "RECV_CHANNEL";
-                    XG_part_no[addr_mid] = value;
-                    break;
-                case XGMIDI_MONO_POLY_MODE: // 0: mono, 1: poly
-                    expl = "MONO_POLY_MODE";
-                    midi.process(part_no, MIDI_NOTE_OFF, 0, 0, true);
-                    if (value == 0) {
-                        mode = MIDI_MONOPHONIC;
-                        channel.set_monophonic(true);
-                    } else {
-                        channel.set_monophonic(false);
-                        mode = MIDI_POLYPHONIC;
-                    }
-                    break;
-                case XGMIDI_KEY_ON_ASSIGN: // 0: multi, 1: inst (for drum)
-                    expl = "KEY_ON_ASSIGN";
-                    LOG(99, "LOG: Unsupported XG sysex Same Note Number Key On Assign\n");
-                    break;
-                case XGMIDI_PART_MODE: // 0: normal, 1: drum, 2-5: drums1-4
-                {
-                    expl = "PART_MODE";
-                    bool drums = value ? true : false;
-                    channel.set_drums(drums);
-                    const char* name = midi.get_channel_type(part_no);
-                    MESSAGE(3, "Set part %i to %s\n", part_no, name);
-                    break;
-                }
-                case XGMIDI_NOTE_SHIFT: // -24 - +24 semitones
-                    expl = "NOTE_SHIFT";
-                    LOG(99, "LOG: Unsupported XG sysex Note Shift\n");
-                    break;
-                case XGMIDI_DETUNE: // -12.8 - 12.7 cent
-                {   // 1st bit3-0: bit7-4, 2nd bit3-0: bit3-0
-                    expl = "DETUNE";
-                    int8_t tune = (value << 4);
-                    float level;
-                    byte = pull_byte();
-                    CSV(part_no, ", %d", byte);
-                    tune |= byte & 0xf;
-                    level = cents2pitch(0.1f*tune, part_no);
-                    channel.set_celeste_depth(level);
-                    break;
-                }
-                case XGMIDI_VOLUME: // 0-127
-                    expl = "VOLUME";
-                    channel.set_gain(aax::math::ln(float(value)/127.0f));
-                    break;
-                case XGMIDI_VELOCITY_SENSE_DEPTH: // 0-127
-                    expl = "VELOCITY_SENSE_DEPTH";
-                    LOG(99, "LOG: Unsupported XG sysex Velocity Sense Depth\n");
-                    break;
-                case XGMIDI_VELOCITY_SENSE_OFFSET: // 0-127
-                    expl = "VELOCITY_SENSE_OFFSET";
-                    LOG(99, "LOG: Unsupported XG sysex Velocity Sense Offset\n");
-                    break;
-                case XGMIDI_PAN: // 0: random, L63 - C - R63 (1 - 64 - 127)
-                    expl = "PAN";
-                    if (mode != MIDI_MONOPHONIC) {
-                        if (value == 0) channel.set_pan(-1.0f + 2.0f*rand()/RAND_MAX);
-                        else channel.set_pan(float(value-64)/64.f);
-                    }
-                    break;
-                case XGMIDI_NOTE_LIMIT_LOW: // C2 - G8
-                    expl = "NOTE_LIMIT_LOW";
-                    LOG(99, "LOG: Unsupported XG sysex Note Limit Low\n");
-                    break;
-                case XGMIDI_NOTE_LIMIT_HIGH: // C2 - G8
-                    expl = "NOTE_LIMIT_HIGH";
-                    LOG(99, "LOG: Unsupported XG sysex Note Limit High\n");
-                    break;
-                case XGMIDI_DRY_LEVEL: // 0-127
-                    expl = "DRY_LEVEL";
-                    LOG(99, "LOG: Unsupported XG sysex Dry Level\n");
-                    break;
-                case XGMIDI_CHORUS_SEND: // 0-127
-                {
-                    expl = "CHORUS_SEND";
-                    float val = float(value)/127.0f;
-                    midi.set_chorus_level(part_no, val);
-                    break;
-                }
-                case XGMIDI_REVERB_SEND: // 0-127
-                {
-                    expl = "REVERB_SEND";
-                    float val = float(value)/127.0f;
-                    midi.set_reverb_level(part_no, val);
-                    break;
-                }
-                case XGMIDI_VARIATION_SEND: // 0-127
-                    expl = "VARIATION_SEND";
-                    LOG(99, "LOG: Unsupported XG sysex Variation Send\n");
-                    break;
-                case XGMIDI_VIBRATO_RATE: // -64 - +63
-                {
-                    expl = "VIBRATO_RATE";
-                    float val = 0.5f + float(value)/64.0f;
-                    channel.set_vibrato_rate(val);
-                    break;
-                }
-                case XGMIDI_VIBRATO_DEPTH: // -64 - +63
-                {
-                    expl = "VIBRATO_DEPTH";
-                    float val = float(value)/64.0f;
-                    channel.set_vibrato_depth(val);
-                    break;
-                }
-                case XGMIDI_VIBRATO_DELAY: // -64 - +63
-                {
-                    expl = "VIBRATO_DELAY";
-                    float val = float(value)/64.0f;
-                    channel.set_vibrato_delay(val);
-                    break;
-                }
-                case XGMIDI_FILTER_CUTOFF_FREQUENCY: // -64 - +63
-                {
-                    expl = "FILTER_CUTOFF_FREQUENCY";
-                    float val = float(value)/64.0f;
-                    if (val < 1.0f) val = 0.5f + 0.5f*val;
-                    channel.set_filter_cutoff(val);
-                    break;
-                }
-                case XGMIDI_FILTER_RESONANCE: // -64 - +63
-                {
-                    expl = "FILTER_RESONANCE";
-                    float val = -1.0f+float(value)/16.0f; // relative: 0.0 - 8.0
-                    channel.set_filter_resonance(val);
-                    break;
-                }
-                case XGMIDI_EG_ATTACK_TIME: // -64 - +63
-                    expl = "EG_ATTACK_TIME";
-//                  channel.set_attack_time(value);
-                    break;
-                case XGMIDI_EG_DECAY_TIME: // -64 - +63
-                    expl = "EG_DECAY_TIME";
-//                  channel.set_decay_time(value);
-                    break;
-                case XGMIDI_EG_RELEASE_TIME: // -64 - +63
-                    expl = "EG_RELEASE_TIME";
-//                  channel.set_release_time(value);
-                    break;
-                case XGMIDI_MW_PITCH_CONTROL: // -24 - +24 semitones
-                {
-                    expl = "MW_PITCH_CONTROL";
-                    float val = 0.375f*(value-64);
-                    channel.set_pitch_depth(val);
-                    break;
-                }
-                case XGMIDI_MW_FILTER_CONTROL: // -9600 - +9450 cents
-                    expl = "MW_FILTER_CONTROL";
-                    LOG(99, "LOG: Unsupported XG sysex Mod Wheel Filter Control\n");
-                    break;
-                case XGMIDI_MW_AMPLITUDE_CONTROL: // -100 - +100%
-                    expl = "MW_AMPLITUDE_CONTROL";
-                    LOG(99, "LOG: Unsupported XG sysex Mod Wheel Amplitude Control\n");
-                    break;
-                case XGMIDI_MW_LFO_PMOD_DEPTH: // 0 - 127
-                    expl = "MW_LFO_PMOD_DEPTH";
-                    LOG(99, "LOG: Unsupported XG sysex Mod Wheel LFO Phase Modulation Depth\n");
-                    break;
-                case XGMIDI_MW_LFO_FMOD_DEPTH: // 0 - 127
-                    expl = "MW_LFO_FMOD_DEPTH";
-                    LOG(99, "LOG: Unsupported XG sysex Mod Wheel LFO Frequency Modulation Depth\n");
-                    break;
-                case XGMIDI_MW_LFO_AMOD_DEPTH: // 0 - 127
-                    expl = "MW_LFO_AMOD_DEPTH";
-                    LOG(99, "LOG: Unsupported XG sysex Mod Wheel LFO Amplitude Modulation Depth\n");
-                    break;
-                case XGMIDI_BEND_PITCH_CONTROL: // // -24 - +24 semitones
-                    expl = "BEND_PITCH_CONTROL";
-                    LOG(99, "LOG: Unsupported XG sysex Bend Pitch Control\n");
-                    break;
-                case XGMIDI_BEND_FILTER_CONTROL: // -9600 - +9450 cents
-                    expl = "BEND_FILTER_CONTROL";
-                    LOG(99, "LOG: Unsupported XG sysex Bend Filter Control\n");
-                    break;
-                case XGMIDI_BEND_AMPLITUDE_CONTROL: // -100 - +100%
-                    expl = "BEND_AMPLITUDE_CONTROL";
-                    LOG(99, "LOG: Unsupported XG sysex Bend Amplitude Control\n");
-                    break;
-                case XGMIDI_BEND_LFO_PMOD_DEPTH: // 0 - 127
-                    expl = "BEND_LFO_PMOD_DEPTH";
-                    LOG(99, "LOG: Unsupported XG sysex Bend LFO Phase Modulation Depth\n");
-                    break;
-                case XGMIDI_BEND_LFO_FMOD_DEPTH: // 0 - 127
-                    expl = "BEND_LFO_FMOD_DEPTH";
-                    LOG(99, "LOG: Unsupported XG sysex Bend LFO Frequency Modulation  Depth\n");
-                    break;
-                case XGMIDI_BEND_LFO_AMOD_DEPTH: // 0 - 127
-                    expl = "BEND_LFO_AMOD_DEPTH";
-                    LOG(99, "LOG: Unsupported XG sysex bend LFO Amplitude Modulation Depth\n");
-                    break;
-                default:
-                    LOG(99, "LOG: Unsupported XG sysex multi part type: 0x%02x (%d)\n",
-                            addr_mid, addr_mid);
-                    break;
-                }
+            {
+                uint8_t n = sysex_pull(XG_part_param, addr_low, value, data);
+                image.write(addr_high, addr_mid, addr_low, data, n, false);
+                rv = sysex_part(XG_part_param, addr_mid, part_no, addr_low,
+                                data, expl);
                 break;
             }
             case XGMIDI_A_D_PART:
@@ -1175,3 +970,191 @@ bool MIDIStream::XG_process_sysex(uint64_t size, std::string& expl)
     return rv;
 }
 
+// F0 43 0n 4C bh bl ah am al dd ... dd cs F7
+bool
+MIDIStream::XG_sysex_bulk_dump(uint64_t size, uint64_t offs, std::string& expl)
+{
+    uint8_t byte = pull_byte();
+    CSV(channel_no, ", %d", byte);
+    if (byte != XGMIDI_MODEL_XG)
+    {
+        if (midi.get_csv(channel_no)) {
+            expl = "Unkown BULK_DUMP " + std::to_string(byte);
+        }
+        LOG(99, "LOG: Unsupported XG sysex bulk dump model: 0x%02x (%d)\n",
+                byte, byte);
+        return false;
+    }
+
+    uint8_t count_high = pull_byte();
+    uint8_t count_low = pull_byte();
+    uint8_t addr_high = pull_byte();
+    uint8_t addr_mid = pull_byte();
+    uint8_t addr_low = pull_byte();
+    uint64_t sum = count_high + count_low + addr_high + addr_mid + addr_low;
+    size_t count = count_high << 7 | count_low;
+    CSV(channel_no, ", %d, %d, %d, %d, %d", count_high, count_low,
+                    addr_high, addr_mid, addr_low);
+
+    // data bytes left, the checksum excluded
+    uint64_t len = offset()-offs;
+    len = (len < size) ? size-len-1 : 0;
+    if (count > len)
+    {
+        expl = "BULK_DUMP: Invalid byte count";
+        return false;
+    }
+
+    std::vector<uint8_t> data(count);
+    for (size_t i=0; i<count; ++i)
+    {
+        data[i] = pull_byte();
+        CSV(channel_no, ", %d", data[i]);
+        sum += data[i];
+    }
+
+    byte = pull_byte();
+    CSV(channel_no, ", %d", byte);
+    if ((sum + byte) & 0x7f)
+    {
+        expl = "BULK_DUMP: Invalid checksum";
+        return false;
+    }
+
+    auto& image = midi.get_sysex_image(XG);
+    image.write(addr_high, addr_mid, addr_low, data.data(), count, true);
+    XG_sysex_flush();
+    if (!image.contains(addr_high)) {
+        LOG(99, "LOG: Unsupported XG sysex bulk dump address: 0x%02x (%d)\n",
+                addr_high, addr_high);
+    }
+    expl = "BULK_DUMP";
+
+    return true;
+}
+
+// Applies the multi part parameters of a bulk dump.
+void
+MIDIStream::XG_sysex_flush()
+{
+    auto& image = midi.get_sysex_image(XG);
+    std::string expl;
+    int prev = -1;
+
+    image.flush([&](uint8_t high, uint8_t mid, uint8_t low)
+    {
+        if (high != XGMIDI_MULTI_PART || mid >= std::size(XG_part_no)) return;
+
+        // the second byte of a two byte parameter
+        if (XG_part_param[low].action == SYSEX_UNKNOWN && low &&
+            XG_part_param[low-1].size == 2) --low;
+
+        if (XG_part_param[low].action == SYSEX_UNKNOWN) return;
+        if ((mid << 7 | low) == prev) return;
+        prev = mid << 7 | low;
+
+        sysex_part(XG_part_param, mid, XG_part_no[mid], low,
+                   image.get(high, mid, low), expl);
+    });
+}
+
+/*
+ * Multi part parameters, address: 0x08 nn 0xnn, nn is the part.
+ * http://www.studio4all.de/htmle/main92.html#xgprgxgpart02a01
+ */
+const sysex_table_t MIDIStream::XG_part_param = make_sysex_table({
+  // 0-127
+  { XGMIDI_BANK_SELECT_MSB, XGMIDI_BANK_SELECT_MSB,
+    "BANK_SELECT_MSB", SYSEX_BANK_SELECT_MSB },
+  // 0-127
+  { XGMIDI_BANK_SELECT_LSB, XGMIDI_BANK_SELECT_LSB,
+    "BANK_SELECT_LSB", SYSEX_BANK_SELECT_LSB },
+  // 1-128
+  { XGMIDI_PROGRAM_NUMBER, XGMIDI_PROGRAM_NUMBER,
+    "PROGRAM_NUMBER", SYSEX_PROGRAM_NUMBER },
+  { XGMIDI_RECV_CHANNEL, XGMIDI_RECV_CHANNEL,
+    "RECV_CHANNEL", SYSEX_RECV_CHANNEL },
+  // 0: mono, 1: poly
+  { XGMIDI_MONO_POLY_MODE, XGMIDI_MONO_POLY_MODE,
+    "MONO_POLY_MODE", SYSEX_POLY_MODE },
+  // 0: multi, 1: inst (for drum)
+  { XGMIDI_KEY_ON_ASSIGN, XGMIDI_KEY_ON_ASSIGN,
+    "KEY_ON_ASSIGN", SYSEX_UNSUPPORTED },
+  // 0: normal, 1: drum, 2-5: drums1-4
+  { XGMIDI_PART_MODE, XGMIDI_PART_MODE, "PART_MODE", SYSEX_DRUMS },
+  // -24 - +24 semitones
+  { XGMIDI_NOTE_SHIFT, XGMIDI_NOTE_SHIFT, "NOTE_SHIFT", SYSEX_UNSUPPORTED },
+  // -12.8 - 12.7 cent, 1st bit3-0: bit7-4, 2nd bit3-0: bit3-0
+  { XGMIDI_DETUNE, XGMIDI_DETUNE, "DETUNE", SYSEX_DETUNE, 2, 0.1f },
+  // 0-127
+  { XGMIDI_VOLUME, XGMIDI_VOLUME, "VOLUME", SYSEX_GAIN, 1, 1.0f/127.0f },
+  { XGMIDI_VELOCITY_SENSE_DEPTH, XGMIDI_VELOCITY_SENSE_DEPTH,
+    "VELOCITY_SENSE_DEPTH", SYSEX_UNSUPPORTED },
+  { XGMIDI_VELOCITY_SENSE_OFFSET, XGMIDI_VELOCITY_SENSE_OFFSET,
+    "VELOCITY_SENSE_OFFSET", SYSEX_UNSUPPORTED },
+  // 0: random, L63 - C - R63 (1 - 64 - 127)
+  { XGMIDI_PAN, XGMIDI_PAN, "PAN", SYSEX_PAN_RANDOM, 1, 1.0f/64.0f, -1.0f },
+  // C2 - G8
+  { XGMIDI_NOTE_LIMIT_LOW, XGMIDI_NOTE_LIMIT_LOW,
+    "NOTE_LIMIT_LOW", SYSEX_UNSUPPORTED },
+  { XGMIDI_NOTE_LIMIT_HIGH, XGMIDI_NOTE_LIMIT_HIGH,
+    "NOTE_LIMIT_HIGH", SYSEX_UNSUPPORTED },
+  // 0-127
+  { XGMIDI_DRY_LEVEL, XGMIDI_DRY_LEVEL, "DRY_LEVEL", SYSEX_UNSUPPORTED },
+  { XGMIDI_CHORUS_SEND, XGMIDI_CHORUS_SEND,
+    "CHORUS_SEND", SYSEX_CHORUS_SEND, 1, 1.0f/127.0f },
+  { XGMIDI_REVERB_SEND, XGMIDI_REVERB_SEND,
+    "REVERB_SEND", SYSEX_REVERB_SEND, 1, 1.0f/127.0f },
+  { XGMIDI_VARIATION_SEND, XGMIDI_VARIATION_SEND,
+    "VARIATION_SEND", SYSEX_UNSUPPORTED },
+  // -64 - +63
+  { XGMIDI_VIBRATO_RATE, XGMIDI_VIBRATO_RATE,
+    "VIBRATO_RATE", SYSEX_VIBRATO_RATE, 1, 1.0f/64.0f, 0.5f },
+  { XGMIDI_VIBRATO_DEPTH, XGMIDI_VIBRATO_DEPTH,
+    "VIBRATO_DEPTH", SYSEX_VIBRATO_DEPTH, 1, 1.0f/64.0f },
+  { XGMIDI_VIBRATO_DELAY, XGMIDI_VIBRATO_DELAY,
+    "VIBRATO_DELAY", SYSEX_VIBRATO_DELAY, 1, 1.0f/64.0f },
+  { XGMIDI_FILTER_CUTOFF_FREQUENCY, XGMIDI_FILTER_CUTOFF_FREQUENCY,
+    "FILTER_CUTOFF_FREQUENCY", SYSEX_FILTER_CUTOFF, 1, 1.0f/64.0f },
+  // relative: 0.0 - 8.0
+  { XGMIDI_FILTER_RESONANCE, XGMIDI_FILTER_RESONANCE,
+    "FILTER_RESONANCE", SYSEX_FILTER_RESONANCE, 1, 1.0f/16.0f, -1.0f },
+  { XGMIDI_EG_ATTACK_TIME, XGMIDI_EG_ATTACK_TIME,
+    "EG_ATTACK_TIME", SYSEX_UNSUPPORTED },
+  { XGMIDI_EG_DECAY_TIME, XGMIDI_EG_DECAY_TIME,
+    "EG_DECAY_TIME", SYSEX_UNSUPPORTED },
+  { XGMIDI_EG_RELEASE_TIME, XGMIDI_EG_RELEASE_TIME,
+    "EG_RELEASE_TIME", SYSEX_UNSUPPORTED },
+  // -24 - +24 semitones
+  { XGMIDI_MW_PITCH_CONTROL, XGMIDI_MW_PITCH_CONTROL,
+    "MW_PITCH_CONTROL", SYSEX_PITCH_DEPTH, 1, 0.375f, -24.0f },
+  // -9600 - +9450 cents
+  { XGMIDI_MW_FILTER_CONTROL, XGMIDI_MW_FILTER_CONTROL,
+    "MW_FILTER_CONTROL", SYSEX_UNSUPPORTED },
+  // -100 - +100%
+  { XGMIDI_MW_AMPLITUDE_CONTROL, XGMIDI_MW_AMPLITUDE_CONTROL,
+    "MW_AMPLITUDE_CONTROL", SYSEX_UNSUPPORTED },
+  // 0 - 127
+  { XGMIDI_MW_LFO_PMOD_DEPTH, XGMIDI_MW_LFO_PMOD_DEPTH,
+    "MW_LFO_PMOD_DEPTH", SYSEX_UNSUPPORTED },
+  { XGMIDI_MW_LFO_FMOD_DEPTH, XGMIDI_MW_LFO_FMOD_DEPTH,
+    "MW_LFO_FMOD_DEPTH", SYSEX_UNSUPPORTED },
+  { XGMIDI_MW_LFO_AMOD_DEPTH, XGMIDI_MW_LFO_AMOD_DEPTH,
+    "MW_LFO_AMOD_DEPTH", SYSEX_UNSUPPORTED },
+  // -24 - +24 semitones
+  { XGMIDI_BEND_PITCH_CONTROL, XGMIDI_BEND_PITCH_CONTROL,
+    "BEND_PITCH_CONTROL", SYSEX_UNSUPPORTED },
+  // -9600 - +9450 cents
+  { XGMIDI_BEND_FILTER_CONTROL, XGMIDI_BEND_FILTER_CONTROL,
+    "BEND_FILTER_CONTROL", SYSEX_UNSUPPORTED },
+  // -100 - +100%
+  { XGMIDI_BEND_AMPLITUDE_CONTROL, XGMIDI_BEND_AMPLITUDE_CONTROL,
+    "BEND_AMPLITUDE_CONTROL", SYSEX_UNSUPPORTED },
+  // 0 - 127
+  { XGMIDI_BEND_LFO_PMOD_DEPTH, XGMIDI_BEND_LFO_PMOD_DEPTH,
+    "BEND_LFO_PMOD_DEPTH", SYSEX_UNSUPPORTED },
+  { XGMIDI_BEND_LFO_FMOD_DEPTH, XGMIDI_BEND_LFO_FMOD_DEPTH,
+    "BEND_LFO_FMOD_DEPTH", SYSEX_UNSUPPORTED },
+  { XGMIDI_BEND_LFO_AMOD_DEPTH, XGMIDI_BEND_LFO_AMOD_DEPTH,
+    "BEND_LFO_AMOD_DEPTH", SYSEX_UNSUPPORTED }
+});
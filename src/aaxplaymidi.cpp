@@ -66,7 +66,11 @@ help()
     printf("  -l, --load <instr>\t\tmidi instrument configuration overlay file\n");
     printf("  -m, --mono\t\t\tplay back in mono mode\n");
     printf("  -b, --batched\t\t\tprocess the file in batched (high-speed) mode.\n");
+    printf("      --live <input>\t\tplay raw MIDI bytes from stdin (-), a FIFO,\n");
+    printf("\t\t\t\tudp:[host:]port or unix:path\n");
     printf("      --grep <regex>\t\t\tgrep a midi file for certain instruments.\n");
+    printf("      --stats\t\t\tprint playback statistics when done\n");
+    printf("      --trace <file>\t\twrite a Chrome trace (JSON) of the playback\n");
     printf("  -v, --verbose <0-4>\t\tshow extra playback information\n");
     printf("  -h, --help\t\t\tprint this message and exit\n");
 
@@ -103,10 +107,46 @@ static void sleep_for(float dt)
     }
 }
 
+static void print_stats(const aaxMIDIStats& s)
+{
+    static const char *event_name[AAX_MIDI_EVENT_MAX] = {
+        "note-off", "note-on", "poly pressure", "control change",
+        "program change", "channel pressure", "pitch bend",
+        "system exclusive", "meta", "system"
+    };
+
+    printf("\nEvents dispatched:\n");
+    for (int i=0; i<AAX_MIDI_EVENT_MAX; ++i) {
+        if (s.events[i]) printf("  %-18s %10lu\n", event_name[i], (unsigned long)s.events[i]);
+    }
+
+    printf("Process   : %lu calls, %.3f ms total, %.1f us average, %u us max\n",
+           (unsigned long)s.process_calls, s.process_time_us*1e-3,
+           s.process_calls ? double(s.process_time_us)/s.process_calls : 0.0,
+           s.process_time_max_us);
+    printf("Instrument: %lu cache hits, %lu misses\n",
+           (unsigned long)s.cache_hits, (unsigned long)s.cache_misses);
+    printf("Patches   : %u loaded, %.1f ms total, %.1f ms max\n",
+           s.patch_loads, s.patch_load_time_us*1e-3,
+           s.patch_load_time_max_us*1e-3);
+    printf("Graph     : %u ensembles, %u mixers\n", s.ensembles, s.mixers);
+    printf("Effects   : %u chorus, %u delay, %u reverb parts\n",
+           s.chorus_parts, s.delay_parts, s.reverb_parts);
+
+    printf("Voices    : channel  keys  active  peak  retriggered\n");
+    for (int i=0; i<MIDI_STATS_MAX_CHANNELS; ++i)
+    {
+        if (!s.voices[i].peak) continue;
+        printf("            %7i  %4u  %6u  %4u  %11u\n", i,
+               s.voices[i].keys, s.voices[i].active, s.voices[i].peak,
+               s.voices[i].retriggered);
+    }
+}
+
 void play(char *devname, enum aaxRenderMode mode, char *infile, char *outfile,
           const char *track, const char *config, float time_offs, float gain,
           const char *grep, bool mono, char verbose, bool batched, bool fm,
-          bool csv)
+          bool csv, bool stats)
 {
     if (grep) devname = (char*)"None"; // fastest for searching
 
@@ -183,37 +223,33 @@ void play(char *devname, enum aaxRenderMode mode, char *infile, char *outfile,
                 }
                 else
                 {
-                    if (!paused)
-                    {
-                        if (!midi.process(time_parts, wait_parts)) break;
+                    if (!midi.process(time_parts, wait_parts)) break;
 
-                        if (wait_parts > 0 && midi.get_pos_sec() >= time_offs)
-                        {
-                            double sleep_us, wait_us;
+                    if (wait_parts > 0 && midi.get_pos_sec() >= time_offs)
+                    {
+                        double sleep_us, wait_us;
 
-                            auto next = std::chrono::high_resolution_clock::now();
-                            std::chrono::duration<double, std::micro> dt_us = next - now;
+                        auto next = std::chrono::high_resolution_clock::now();
+                        std::chrono::duration<double, std::micro> dt_us = next - now;
 
-                            wait_us = wait_parts*midi.get_uspp();
-                            sleep_us = wait_us - dt_us.count();
+                        wait_us = wait_parts*midi.get_uspp();
+                        sleep_us = wait_us - dt_us.count();
 
-                            if (wait_us > 1e66)
-                            {
-                                if (wait_us > 15e6) break;
-//                              sleep_us = 1.0;
-                            }
-
-                            if (sleep_us > 0) {
-                                sleep_for(sleep_us*1e-6f);
-                            }
+                        if (wait_us > 1e66)
+                        {
+                            if (wait_us > 15e6) break;
+//                          sleep_us = 1.0;
+                        }
 
-                            now = std::chrono::high_resolution_clock::now();
+                        if (sleep_us > 0)
+                        {
+                            aax::MIDITraceSleep trace(sleep_us*1e-6f);
+                            sleep_for(sleep_us*1e-6f);
                         }
-                        time_parts += wait_parts;
-                    }
-                    else {
-                        sleep_for(0.1f);
+
+                        now = std::chrono::high_resolution_clock::now();
                     }
+                    time_parts += wait_parts;
 
                     key = get_key();
                     if (key)
@@ -222,13 +258,13 @@ void play(char *devname, enum aaxRenderMode mode, char *infile, char *outfile,
                         {
                             if (paused)
                             {
-                                midi.set(AAX_PLAYING);
+                                midi.post_resume();
                                 printf("\nRestart playback.\n");
                                 paused = AAX_FALSE;
                             }
                             else
                             {
-                                midi.set(AAX_SUSPENDED);
+                                midi.post_pause();
                                 printf("\nPause playback.\n");
                                 paused = AAX_TRUE;
                             }
@@ -242,6 +278,13 @@ void play(char *devname, enum aaxRenderMode mode, char *infile, char *outfile,
             while(true);
             set_mode(0);
             midi.stop();
+
+            if (stats)
+            {
+                aaxMIDIStats s;
+                midi.get_stats(s);
+                print_stats(s);
+            }
         }
     } catch (const std::exception& e) {
         if (!csv) {
@@ -251,6 +294,51 @@ void play(char *devname, enum aaxRenderMode mode, char *infile, char *outfile,
     }
 }
 
+void play_live(char *devname, enum aaxRenderMode mode, const char *input,
+               const char *config, float gain, bool mono, char verbose,
+               bool stats)
+{
+    try {
+        aax::MIDIInput midi(devname, input, nullptr, mode, config);
+        uint64_t time_parts = 0;
+        uint32_t wait_parts = 0;
+
+        midi.set_volume(gain);
+        midi.set_verbose(verbose);
+        midi.set_mono(mono);
+        midi.initialize();
+        midi.start();
+
+        // the keyboard can't be used to stop when reading from stdin
+        bool keys = strcmp(input, "-") && strcmp(input, "stdin");
+        if (keys) set_mode(1);
+        do
+        {
+            if (!midi.process(time_parts, wait_parts)) break;
+            time_parts += wait_parts;
+
+            float dt = wait_parts*midi.get_uspp()*1e-6f;
+            aax::MIDITraceSleep trace(dt);
+            sleep_for(dt);
+        }
+        while (!keys || !get_key());
+        if (keys) set_mode(0);
+
+        midi.stop();
+        midi.print_latency_histogram();
+
+        if (stats)
+        {
+            aaxMIDIStats s;
+            midi.get_stats(s);
+            print_stats(s);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error while processing live MIDI input: " << std::endl
+                  << "    " << e.what() << std::endl;
+    }
+}
+
 int verbose = 0;
 int main(int argc, char **argv)
 {
@@ -271,6 +359,7 @@ int main(int argc, char **argv)
     bool batched = false;
     char mono = false;
     bool csv = false;
+    bool stats = false;
     char verbose = 0;
     bool fm = false;
     float gain = 1.0f;
@@ -323,8 +412,27 @@ int main(int argc, char **argv)
             csv = true;
         }
 
-        std::thread midiThread(play, devname, render_mode, infile, outfile, track, config, time_offs, gain, grep, mono, verbose, batched, fm, csv);
+        if (getCommandLineOption(argc, argv, "--stats")) {
+            stats = true;
+        }
+
+        arg = getCommandLineOption(argc, argv, "--trace");
+        if (arg && !aaxMIDITraceOpen(arg)) {
+            std::cerr << "Unable to open the trace file: " << arg << std::endl;
+        }
+
+        arg = getCommandLineOption(argc, argv, "--live");
+        if (arg)
+        {
+            std::thread midiThread(play_live, devname, render_mode, arg, config, gain, mono, verbose, stats);
+            midiThread.join();
+            aaxMIDITraceClose();
+            return 0;
+        }
+
+        std::thread midiThread(play, devname, render_mode, infile, outfile, track, config, time_offs, gain, grep, mono, verbose, batched, fm, csv, stats);
         midiThread.join();
+        aaxMIDITraceClose();
 
     } catch (const std::exception& e) {
         if (!csv) {
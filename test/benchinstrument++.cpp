@@ -0,0 +1,433 @@
+/*
+ * Copyright (C) 2024 by Erik Hofman.
+ * Copyright (C) 2024 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provimed that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provimed with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <malloc.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <iterator>
+#include <functional>
+#include <algorithm>
+#include <type_traits>
+
+#include <aax/instrument>
+
+#include "base/types.h"
+#include "driver.h"
+
+#define DEFAULT_DEVICE		"None"
+#define FILE_PATH		SRC_PATH"/tictac.wav"
+#define DEFAULT_MEMBERS		"0,1,4,16"
+#define DEFAULT_VOICES		"1,10,100,1000"
+#define DEFAULT_REPEAT		5
+#define DEFAULT_ITERATIONS	100
+#define DEFAULT_THRESHOLD	0.1f
+
+void help()
+{
+    printf("Usage: benchinstrument++ [options]\n");
+    printf("Measures the cost of the voice engine: note-on and note-off\n");
+    printf("latency, the controller fan-out to all playing voices and the\n");
+    printf("memory used per voice, for instruments and ensembles.\n");
+    printf("The results are written as one JSON object per test case.\n");
+
+    printf("\nOptions:\n");
+    printf("  -d, --device <device>\t\tplayback device (default: None)\n");
+    printf("  -i, --input <file>\t\tthe sample file to use for every voice\n");
+    printf("      --members <n,..>\t\tensemble members, 0 is a plain instrument\n");
+    printf("\t\t\t\t(default: %s)\n", DEFAULT_MEMBERS);
+    printf("      --voices <n,..>\t\tsimultaneous voices (default: %s)\n", DEFAULT_VOICES);
+    printf("      --repeat <n>\t\tnote-on/off cycles per case (default: %i)\n", DEFAULT_REPEAT);
+    printf("      --iterations <n>\t\tcalls per controller (default: %i)\n", DEFAULT_ITERATIONS);
+    printf("      --baseline <file>\t\tcompare against previously saved results\n");
+    printf("      --threshold <0.0-1.0>\tallowed slowdown (default: %.2f)\n", DEFAULT_THRESHOLD);
+    printf("  -o, --output <file>\t\talso write the results to a file\n");
+    printf("  -h, --help\t\t\tprint this message and exit\n");
+
+    printf("\nThe exit code is non-zero if any result regressed by more\n");
+    printf("than the threshold compared to the baseline.\n");
+
+    printf("\n");
+
+    exit(-1);
+}
+
+using clock_type = std::chrono::steady_clock;
+using metrics_t = std::vector<std::pair<std::string,double>>;
+
+struct result_t
+{
+    std::string name;
+    metrics_t metrics;
+};
+
+static double
+nsec(clock_type::time_point start)
+{
+    auto dt = clock_type::now() - start;
+    return std::chrono::duration<double, std::nano>(dt).count();
+}
+
+static size_t
+heap_in_use()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    struct mallinfo2 mi = mallinfo2();
+    return mi.uordblks + mi.hblkhd;
+#elif defined(__GLIBC__)
+    struct mallinfo mi = mallinfo();
+    return (unsigned)mi.uordblks + (unsigned)mi.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+static std::vector<int>
+get_list(const char *s)
+{
+    std::vector<int> rv;
+    while (s && *s)
+    {
+        rv.push_back(atoi(s));
+        s = strchr(s, ',');
+        if (s) s++;
+    }
+    return rv;
+}
+
+// mean and 99th percentile of a set of samples
+static void
+add_latency(metrics_t& m, const char *name, std::vector<double>& v)
+{
+    double mean = 0.0;
+    for (double d : v) mean += d;
+    mean /= _MAX(v.size(), size_t(1));
+
+    std::sort(v.begin(), v.end());
+    double p99 = v.empty() ? 0.0 : v[(v.size()-1)*99/100];
+
+    m.emplace_back(std::string(name)+"_ns", mean);
+    m.emplace_back(std::string(name)+"_p99_ns", p99);
+}
+
+/*
+ * A case consists of an instrument (members == 0) or an ensemble with
+ * a number of members, playing a number of keys. Every key of every
+ * member allocates 'count' voices which are needed to get more than
+ * 128 voices for a plain instrument.
+ */
+template<class T>
+static result_t
+run_case(aeonwave::AeonWave& aax, aeonwave::Buffer& buffer, int members,
+         int voices, int repeat, int iterations)
+{
+    int m = _MAX(members, 1);
+    int count = 1;
+    int keys = _MAX(voices/m, 1);
+    if (keys > MAX_NO_NOTES)
+    {
+        count = (keys + MAX_NO_NOTES-1)/MAX_NO_NOTES;
+        keys = (voices + m*count-1)/(m*count);
+    }
+    int first = _MAX(64 - keys/2, 0);
+    int last = first + keys;
+
+    result_t rv;
+    rv.name = members ? "ensemble-"+std::to_string(members) : "instrument";
+    rv.name += "/"+std::to_string(voices);
+
+    size_t heap_start = heap_in_use();
+
+    std::unique_ptr<T> inst;
+    if constexpr (std::is_same_v<T, aeonwave::Ensemble>)
+    {
+        inst.reset(new aeonwave::Ensemble(aax));
+        for (int i=0; i<members; ++i) {
+            inst->add_member(buffer, 1.0f, 1.0f/members, count);
+        }
+    }
+    else {
+        inst.reset(new T(aax, buffer, false, 0, true, count));
+    }
+    aax.add(*inst);
+
+    // the first note-on of every key allocates the voices
+    std::vector<double> cold, on, off;
+    size_t heap_idle = heap_in_use();
+    for (int k=first; k<last; ++k)
+    {
+        auto start = clock_type::now();
+        inst->play(k, 100);
+        cold.push_back(nsec(start));
+    }
+    size_t heap_playing = heap_in_use();
+
+    for (int r=0; r<repeat; ++r)
+    {
+        for (int k=first; k<last; ++k)
+        {
+            auto start = clock_type::now();
+            inst->stop(k, 64);
+            off.push_back(nsec(start));
+        }
+        for (int k=first; k<last; ++k)
+        {
+            auto start = clock_type::now();
+            inst->play(k, 100);
+            on.push_back(nsec(start));
+        }
+    }
+
+    // every controller fans out to all voices of all members
+    T& i = *inst;
+    const std::pair<const char*, std::function<void(int)>> controllers[] = {
+        { "pitch", [&](int n) { i.set_pitch(1.0f + 0.001f*(n & 7)); } },
+        { "pressure", [&](int n) { i.set_pressure((n & 127)/127.0f); } },
+        { "pan", [&](int n) { i.set_pan(((n & 127)-64)/64.0f); } },
+        { "hold", [&](int n) { i.set_hold(bool(n & 1)); } },
+        { "soft", [&](int n) { i.set_soft((n & 127)/127.0f); } },
+        { "expression", [&](int n) { i.set_expression((n & 127)/127.0f); } },
+        { "modulation", [&](int n) { i.set_modulation((n & 127)/127.0f); } },
+        { "attack", [&](int n) { i.set_attack_time(n & 127); } }
+    };
+
+    metrics_t fanout;
+    double fanout_total = 0.0;
+    for (auto& c : controllers)
+    {
+        auto start = clock_type::now();
+        for (int n=0; n<iterations; ++n) {
+            c.second(n);
+        }
+        double ns = nsec(start)/iterations;
+        fanout.emplace_back(std::string(c.first)+"_ns", ns);
+        fanout_total += ns;
+    }
+    i.set_hold(false);
+
+    for (int k=first; k<last; ++k) {
+        inst->stop(k, 64);
+    }
+
+    int active = keys*m*count;
+    rv.metrics.emplace_back("voices", active);
+    add_latency(rv.metrics, "note_on_cold", cold);
+    add_latency(rv.metrics, "note_on", on);
+    add_latency(rv.metrics, "note_off", off);
+    for (auto& it : fanout) {
+        rv.metrics.push_back(it);
+    }
+    rv.metrics.emplace_back("fanout_per_voice_ns",
+                            fanout_total/std::size(controllers)/active);
+    rv.metrics.emplace_back("instrument_bytes", double(heap_idle - heap_start));
+    rv.metrics.emplace_back("bytes_per_voice",
+                            double(heap_playing - heap_idle)/active);
+
+    aax.remove(*inst);
+
+    return rv;
+}
+
+static void
+print_result(FILE *fp, const result_t& r)
+{
+    fprintf(fp, "{\"case\":\"%s\"", r.name.c_str());
+    for (auto& it : r.metrics) {
+        fprintf(fp, ",\"%s\":%.1f", it.first.c_str(), it.second);
+    }
+    fprintf(fp, "}\n");
+    fflush(fp);
+}
+
+// Reads the results which were written by print_result()
+static std::vector<result_t>
+read_baseline(const char *filename)
+{
+    std::vector<result_t> rv;
+
+    FILE *fp = fopen(filename, "r");
+    if (!fp)
+    {
+        printf("Unable to open the baseline file: %s\n", filename);
+        return rv;
+    }
+
+    char line[4096];
+    while (fgets(line, sizeof(line), fp))
+    {
+        char *s = strstr(line, "\"case\":\"");
+        if (!s) continue;
+
+        result_t r;
+        s += strlen("\"case\":\"");
+        char *e = strchr(s, '"');
+        if (!e) continue;
+        r.name = std::string(s, e-s);
+
+        s = e+1;
+        while ((s = strchr(s, ',')) != nullptr)
+        {
+            char *key = strchr(s, '"');
+            if (!key) break;
+            e = strchr(++key, '"');
+            if (!e || e[1] != ':') break;
+            r.metrics.emplace_back(std::string(key, e-key), atof(e+2));
+            s = e+2;
+        }
+        rv.push_back(r);
+    }
+    fclose(fp);
+
+    return rv;
+}
+
+// Only the time and memory metrics count, lower is better for all of them.
+static int
+compare(const result_t& r, const std::vector<result_t>& baseline,
+        float threshold)
+{
+    int rv = 0;
+    for (auto& b : baseline)
+    {
+        if (b.name != r.name) continue;
+
+        for (auto& bm : b.metrics)
+        {
+            const std::string& name = bm.first;
+            bool ns = name.size() > 3 && !name.compare(name.size()-3, 3, "_ns");
+            bool bytes = name.find("bytes") != std::string::npos;
+            if ((!ns && !bytes) || bm.second <= 0.0) continue;
+
+            auto it = std::find_if(r.metrics.begin(), r.metrics.end(),
+                         [&](const auto& m) { return m.first == name; });
+            if (it == r.metrics.end()) continue;
+
+            float dv = it->second/bm.second - 1.0;
+            if (dv > threshold)
+            {
+                printf("REGRESSION %s: %s %.1f -> %.1f (+%.0f%%)\n",
+                        r.name.c_str(), name.c_str(), bm.second, it->second,
+                        100.0f*dv);
+                rv++;
+            }
+        }
+    }
+    return rv;
+}
+
+int main(int argc, char **argv)
+{
+    if (getCommandLineOption(argc, argv, "-h") ||
+        getCommandLineOption(argc, argv, "--help"))
+    {
+        help();
+    }
+
+    char *env;
+
+    char *devname = getCommandLineOption(argc, argv, "-d");
+    if (!devname) devname = getCommandLineOption(argc, argv, "--device");
+    if (!devname) devname = (char*)DEFAULT_DEVICE;
+
+    char *infile = getInputFile(argc, argv, FILE_PATH);
+
+    env = getCommandLineOption(argc, argv, "--members");
+    std::vector<int> members = get_list(env ? env : DEFAULT_MEMBERS);
+
+    env = getCommandLineOption(argc, argv, "--voices");
+    std::vector<int> voices = get_list(env ? env : DEFAULT_VOICES);
+
+    int repeat = DEFAULT_REPEAT;
+    env = getCommandLineOption(argc, argv, "--repeat");
+    if (env) repeat = _MAX(atoi(env), 1);
+
+    int iterations = DEFAULT_ITERATIONS;
+    env = getCommandLineOption(argc, argv, "--iterations");
+    if (env) iterations = _MAX(atoi(env), 1);
+
+    float threshold = DEFAULT_THRESHOLD;
+    env = getCommandLineOption(argc, argv, "--threshold");
+    if (env) threshold = _MAX(atof(env), 0.0f);
+
+    std::vector<result_t> baseline;
+    env = getCommandLineOption(argc, argv, "--baseline");
+    if (env) baseline = read_baseline(env);
+
+    char *outfile = getCommandLineOption(argc, argv, "-o");
+    if (!outfile) outfile = getCommandLineOption(argc, argv, "--output");
+    FILE *out = outfile ? fopen(outfile, "w") : nullptr;
+
+    aeonwave::AeonWave aax(devname, AAX_MODE_WRITE_STEREO);
+    TRY( aax.set(AAX_INITIALIZED) );
+    TRY( aax.set(AAX_PLAYING) );
+
+    aeonwave::Buffer& buffer = aax.buffer(infile);
+    if (!buffer)
+    {
+        printf("Unable to load the sample file: %s\n", infile);
+        if (out) fclose(out);
+        return -1;
+    }
+
+    int regressions = 0;
+    for (int m : members)
+    {
+        for (int v : voices)
+        {
+            if (m < 0 || v < 1) continue;
+
+            result_t r = m ?
+                run_case<aeonwave::Ensemble>(aax, buffer, m, v, repeat, iterations) :
+                run_case<aeonwave::Instrument>(aax, buffer, m, v, repeat, iterations);
+            print_result(stdout, r);
+            if (out) print_result(out, r);
+            regressions += compare(r, baseline, threshold);
+        }
+    }
+
+    TRY( aax.set(AAX_STOPPED) );
+    if (out) fclose(out);
+
+    if (regressions) {
+        printf("%i result(s) regressed by more than %.0f%%\n",
+                regressions, 100.0f*threshold);
+    }
+
+    return regressions ? 1 : 0;
+}
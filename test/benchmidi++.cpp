@@ -0,0 +1,323 @@
+/*
+ * Copyright (C) 2024 by Erik Hofman.
+ * Copyright (C) 2024 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provimed that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provimed with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+
+#include <aax/midi.h>
+
+#include "base/types.h"
+#include "driver.h"
+#include "smf_writer.hpp"
+
+#define DEFAULT_DEVICE		"None"
+#define DEFAULT_TRACKS		16
+#define DEFAULT_PPQN		480
+#define DEFAULT_NOTES		2000
+#define DEFAULT_DENSITY		4.0f
+#define DEFAULT_REPEAT		3
+#define DRUMS_CHANNEL		9
+
+void help()
+{
+    printf("Usage: benchmidi++ [options]\n");
+    printf("Generates a synthetic MIDI file and measures how fast it gets\n");
+    printf("loaded, initialized and processed. The results are written as\n");
+    printf("one JSON object per run.\n");
+
+    printf("\nOptions:\n");
+    printf("  -d, --device <device>\t\tplayback device (default: None)\n");
+    printf("      --tracks <n>\t\tnumber of note tracks (default: %i)\n", DEFAULT_TRACKS);
+    printf("      --ppqn <n>\t\tparts per quarter note (default: %i)\n", DEFAULT_PPQN);
+    printf("      --notes <n>\t\tnotes per track (default: %i)\n", DEFAULT_NOTES);
+    printf("      --density <n>\t\tnotes per quarter note (default: %.0f)\n", DEFAULT_DENSITY);
+    printf("      --burst <n>\t\tcontroller burst length, every 16 notes\n");
+    printf("      --sysex <0.0-1.0>\t\tchance of a system exclusive message per note\n");
+    printf("      --no-running-status\tinclude the status byte with every event\n");
+    printf("      --lookahead <sec>\t\tlook-ahead parser window (default: 0)\n");
+    printf("      --no-timeline\t\tparse every track on its own while playing\n");
+    printf("      --repeat <n>\t\tnumber of runs (default: %i)\n", DEFAULT_REPEAT);
+    printf("      --seed <n>\t\trandom number generator seed\n");
+    printf("      --keep <file>\t\tsave the generated MIDI file\n");
+    printf("  -o, --output <file>\t\tappend the results to a file\n");
+    printf("  -h, --help\t\t\tprint this message and exit\n");
+
+    printf("\n");
+
+    exit(-1);
+}
+
+struct options_t
+{
+    int tracks = DEFAULT_TRACKS;
+    int ppqn = DEFAULT_PPQN;
+    int notes = DEFAULT_NOTES;
+    float density = DEFAULT_DENSITY;
+    int burst = 0;
+    float sysex = 0.0f;
+    bool running_status = true;
+    unsigned int seed = 1;
+};
+
+static std::vector<uint8_t>
+generate(const options_t& o, uint64_t& no_events)
+{
+    static const uint8_t tempo[] = { 0x07, 0xa1, 0x20 }; // 500000 us
+    static const uint8_t time_sig[] = { 4, 2, 24, 8 };
+    static const uint8_t controllers[] = {
+        MIDI_MODULATION_DEPTH, MIDI_CHANNEL_VOLUME, MIDI_PAN, MIDI_EXPRESSION
+    };
+    // GM master volume and GS reverb macro
+    static const uint8_t gm_volume[] = {
+        0x7f, 0x7f, 0x04, 0x01, 0x00, 0x70, 0xf7
+    };
+    static const uint8_t gs_reverb[] = {
+        0x41, 0x10, 0x42, 0x12, 0x40, 0x01, 0x30, 0x04, 0x0b, 0xf7
+    };
+
+    std::mt19937 rng(o.seed);
+    std::uniform_int_distribution<int> key(36, 96);
+    std::uniform_int_distribution<int> velocity(32, 127);
+    std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+
+    smf_writer smf(o.running_status);
+    uint32_t step = _MAX(o.ppqn/o.density, 2);
+
+    no_events = 0;
+    smf.header(1, o.tracks+1, o.ppqn);
+
+    // conductor track
+    smf.begin_track();
+    smf.meta(0, MIDI_SET_TEMPO, tempo, sizeof(tempo));
+    smf.meta(0, MIDI_TIME_SIGNATURE, time_sig, sizeof(time_sig));
+    smf.end_track();
+    no_events += 3;
+
+    for (int t=0; t<o.tracks; ++t)
+    {
+        uint8_t channel = t % 16;
+        if (channel == DRUMS_CHANNEL) channel = (channel+1) % 16;
+
+        smf.begin_track();
+        smf.channel(0, MIDI_PROGRAM_CHANGE|channel, t % 128);
+        no_events++;
+
+        for (int n=0; n<o.notes; ++n)
+        {
+            if (o.burst && (n % 16) == 0)
+            {
+                uint8_t c = controllers[(n/16) % sizeof(controllers)];
+                for (int b=0; b<o.burst; ++b)
+                {
+                    uint8_t val = (b*127)/_MAX(o.burst-1, 1);
+                    smf.channel(0, MIDI_CONTROL_CHANGE|channel, c, val);
+                }
+                no_events += o.burst;
+            }
+
+            if (o.sysex > 0.0f && chance(rng) < o.sysex)
+            {
+                if (n & 1) smf.sysex(0, gm_volume, sizeof(gm_volume));
+                else smf.sysex(0, gs_reverb, sizeof(gs_reverb));
+                no_events++;
+            }
+
+            // note-off as note-on with zero velocity benefits the most
+            // from running status
+            uint8_t k = key(rng);
+            smf.channel(step/2, MIDI_NOTE_ON|channel, k, velocity(rng));
+            smf.channel(step - step/2, MIDI_NOTE_ON|channel, k, 0);
+            no_events += 2;
+        }
+        smf.end_track();
+        no_events++;
+    }
+
+    return smf.data;
+}
+
+static double
+msec(std::chrono::steady_clock::time_point start)
+{
+    auto dt = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::milli>(dt).count();
+}
+
+int main(int argc, char **argv)
+{
+    using clock = std::chrono::steady_clock;
+
+    if (getCommandLineOption(argc, argv, "-h") ||
+        getCommandLineOption(argc, argv, "--help"))
+    {
+        help();
+    }
+
+    options_t o;
+    char *env;
+
+    char *devname = getCommandLineOption(argc, argv, "-d");
+    if (!devname) devname = getCommandLineOption(argc, argv, "--device");
+    if (!devname) devname = (char*)DEFAULT_DEVICE;
+
+    env = getCommandLineOption(argc, argv, "--tracks");
+    if (env) o.tracks = _MINMAX(atoi(env), 1, 0xfffe);
+    env = getCommandLineOption(argc, argv, "--ppqn");
+    if (env) o.ppqn = _MINMAX(atoi(env), 24, 0x7fff);
+    env = getCommandLineOption(argc, argv, "--notes");
+    if (env) o.notes = _MAX(atoi(env), 1);
+    env = getCommandLineOption(argc, argv, "--density");
+    if (env) o.density = _MAX(atof(env), 0.01f);
+    env = getCommandLineOption(argc, argv, "--burst");
+    if (env) o.burst = _MAX(atoi(env), 0);
+    env = getCommandLineOption(argc, argv, "--sysex");
+    if (env) o.sysex = _MINMAX(atof(env), 0.0f, 1.0f);
+    env = getCommandLineOption(argc, argv, "--seed");
+    if (env) o.seed = atoi(env);
+    if (getCommandLineOption(argc, argv, "--no-running-status")) {
+        o.running_status = false;
+    }
+
+    int repeat = DEFAULT_REPEAT;
+    env = getCommandLineOption(argc, argv, "--repeat");
+    if (env) repeat = _MAX(atoi(env), 1);
+
+    env = getCommandLineOption(argc, argv, "--lookahead");
+    float lookahead = env ? _MAX(atof(env), 0.0f) : 0.0f;
+    bool timeline = !getCommandLineOption(argc, argv, "--no-timeline");
+
+    uint64_t no_events;
+    auto start = clock::now();
+    std::vector<uint8_t> smf = generate(o, no_events);
+    double generate_ms = msec(start);
+
+    std::filesystem::path filename;
+    char *keep = getCommandLineOption(argc, argv, "--keep");
+    if (keep) {
+        filename = keep;
+    }
+    else
+    {
+        filename = std::filesystem::temp_directory_path();
+        filename.append("benchmidi++-" + std::to_string(std::random_device()()) + ".mid");
+    }
+
+    std::string path = filename.string();
+    FILE *fp = fopen(path.c_str(), "wb");
+    if (!fp || fwrite(smf.data(), 1, smf.size(), fp) != smf.size())
+    {
+        printf("Unable to write the MIDI file: %s\n", path.c_str());
+        if (fp) fclose(fp);
+        return -1;
+    }
+    fclose(fp);
+    char *outfile = getCommandLineOption(argc, argv, "-o");
+    if (!outfile) outfile = getCommandLineOption(argc, argv, "--output");
+    FILE *out = outfile ? fopen(outfile, "a") : stdout;
+    if (!out) out = stdout;
+
+    int rv = 0;
+    for (int r=0; r<repeat; ++r)
+    {
+        try
+        {
+            start = clock::now();
+            aax::MIDI midi(devname, path.c_str());
+            double load_ms = msec(start);
+
+            start = clock::now();
+            midi.initialize(nullptr);
+            double initialize_ms = msec(start);
+
+            // after initialize() which reads the environment variables
+            midi.set_lookahead(lookahead);
+            midi.set_timeline(timeline);
+            midi.start();
+
+            uint64_t time_parts = 0;
+            uint32_t wait_parts = 1000;
+            start = clock::now();
+            while (midi.process(time_parts, wait_parts)) {
+                time_parts += wait_parts;
+            }
+            double process_ms = msec(start);
+
+            midi.stop();
+
+            aaxMIDIStats stats;
+            midi.get_stats(stats);
+
+            uint64_t dispatched = 0;
+            for (int i=0; i<AAX_MIDI_EVENT_MAX; ++i) {
+                dispatched += stats.events[i];
+            }
+
+            fprintf(out, "{\"run\":%i,\"device\":\"%s\",\"tracks\":%i,"
+                    "\"ppqn\":%i,\"notes\":%i,\"density\":%.2f,\"burst\":%i,"
+                    "\"sysex\":%.3f,\"running_status\":%s,"
+                    "\"timeline\":%s,\"lookahead\":%.3f,\"bytes\":%lu,"
+                    "\"events\":%lu,\"generate_ms\":%.3f,\"load_ms\":%.3f,"
+                    "\"initialize_ms\":%.3f,\"process_ms\":%.3f,"
+                    "\"process_calls\":%lu,\"dispatched\":%lu,"
+                    "\"events_per_sec\":%.0f}\n",
+                    r, devname, o.tracks, o.ppqn, o.notes, o.density, o.burst,
+                    o.sysex, o.running_status ? "true" : "false",
+                    timeline ? "true" : "false", lookahead,
+                    (unsigned long)smf.size(), (unsigned long)no_events,
+                    generate_ms, load_ms, initialize_ms, process_ms,
+                    (unsigned long)stats.process_calls,
+                    (unsigned long)dispatched,
+                    process_ms > 0.0 ? dispatched*1e3/process_ms : 0.0);
+            fflush(out);
+        }
+        catch (const std::exception& e)
+        {
+            printf("Error while processing the MIDI file: %s\n", e.what());
+            rv = -1;
+            break;
+        }
+    }
+
+    if (out != stdout) fclose(out);
+    if (!keep) std::filesystem::remove(filename);
+
+    return rv;
+}
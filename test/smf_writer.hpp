@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2024 by Erik Hofman.
+ * Copyright (C) 2024 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provimed that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provimed with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <aax/midi.h>
+
+// Standard MIDI File writer
+class smf_writer
+{
+public:
+    smf_writer(bool rs) : running_status(rs) {}
+
+    void begin_track() {
+        start = data.size();
+        put_long(0x4d54726b); // "MTrk"
+        put_long(0);
+        previous = 0;
+    }
+
+    void end_track() {
+        meta(0, MIDI_END_OF_TRACK, nullptr, 0);
+        uint32_t len = data.size() - start - 8;
+        for (int i=0; i<4; ++i) {
+            data[start+4+i] = (len >> (24-8*i)) & 0xff;
+        }
+    }
+
+    void header(uint16_t format, uint16_t tracks, uint16_t ppqn) {
+        put_long(0x4d546864); // "MThd"
+        put_long(6);
+        put_word(format);
+        put_word(tracks);
+        put_word(ppqn);
+    }
+
+    void channel(uint32_t delta, uint8_t status, uint8_t d1, int d2 = -1) {
+        put_vlq(delta);
+        if (!running_status || status != previous) {
+            data.push_back(status);
+        }
+        previous = status;
+        data.push_back(d1);
+        if (d2 >= 0) data.push_back(d2);
+    }
+
+    void meta(uint32_t delta, uint8_t type, const uint8_t *d, uint32_t len) {
+        put_vlq(delta);
+        data.push_back(MIDI_FILE_META_EVENT);
+        data.push_back(type);
+        put_vlq(len);
+        data.insert(data.end(), d, d+len);
+        previous = 0; // cancels running status
+    }
+
+    // d excludes the leading F0 but includes the terminating F7
+    void sysex(uint32_t delta, const uint8_t *d, uint32_t len) {
+        put_vlq(delta);
+        data.push_back(MIDI_SYSTEM_EXCLUSIVE);
+        put_vlq(len);
+        data.insert(data.end(), d, d+len);
+        previous = 0;
+    }
+
+    std::vector<uint8_t> data;
+
+private:
+    void put_word(uint16_t w) {
+        data.push_back(w >> 8);
+        data.push_back(w & 0xff);
+    }
+    void put_long(uint32_t l) {
+        put_word(l >> 16);
+        put_word(l & 0xffff);
+    }
+    void put_vlq(uint32_t v) {
+        uint8_t buf[4];
+        int n = 0;
+        do {
+            buf[n++] = v & 0x7f;
+            v >>= 7;
+        } while (v && n < 4);
+        while (n--) data.push_back(buf[n] | (n ? 0x80 : 0));
+    }
+
+    size_t start = 0;
+    uint8_t previous = 0;
+    bool running_status;
+};
@@ -205,8 +205,8 @@ float add_buffer(aeonwave::AeonWave& driver, aeonwave::Ensemble& ensemble,
                                 dt /= float(buffer.get(AAX_SAMPLE_RATE));
                                 if (dt > duration) duration = dt;
                                 auto& m = ensemble.add_member(buffer, pitch, gain);
-                                m->set_note_minmax(min, max);
-                                m->set_velocity_fraction(velocity);
+                                m.set_note_minmax(min, max);
+                                m.set_velocity_fraction(velocity);
                             }
                         }
                     }
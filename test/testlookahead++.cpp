@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2024 by Erik Hofman.
+ * Copyright (C) 2024 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provimed that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provimed with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <filesystem>
+
+#include <aax/midi.h>
+
+#include "driver.h"
+#include "smf_writer.hpp"
+
+#define DEFAULT_DEVICE		"None"
+#define PPQN			96
+#define NOTES			400
+#define TIMEOUT_SEC		30
+#define MAX_PARTS		(4*NOTES*PPQN/8)
+
+/*
+ * Plays a short song to the end with the look-ahead parser for a number
+ * of window sizes, down to a window which is smaller than the time between
+ * two events. Every run has to dispatch just as many events as a run
+ * without the parser, a run which does not end within the timeout counts
+ * as a deadlock.
+ */
+
+static std::vector<uint8_t>
+song()
+{
+    static const uint8_t tempo[] = { 0x07, 0xa1, 0x20 }; // 500000 us
+    static const uint8_t gm_volume[] = {
+        0x7f, 0x7f, 0x04, 0x01, 0x00, 0x70, 0xf7
+    };
+
+    // a large message of the non-commercial vendor ID, which is skipped
+    std::vector<uint8_t> dump(300, 0);
+    dump.front() = 0x7d;
+    dump.back() = MIDI_SYSTEM_EXCLUSIVE_END;
+
+    smf_writer smf(true);
+    smf.header(1, 3, PPQN);
+
+    smf.begin_track();
+    smf.meta(0, MIDI_SET_TEMPO, tempo, sizeof(tempo));
+    smf.sysex(0, gm_volume, sizeof(gm_volume));
+    smf.end_track();
+
+    for (uint8_t channel=0; channel<2; ++channel)
+    {
+        smf.begin_track();
+        smf.channel(0, MIDI_PROGRAM_CHANGE|channel, 0);
+        for (int n=0; n<NOTES; ++n)
+        {
+            uint8_t key = 48 + (n % 24) + 12*channel;
+            if ((n % 50) == 0) smf.sysex(0, dump.data(), dump.size());
+            if ((n % 8) == 0) {
+                smf.channel(0, MIDI_CONTROL_CHANGE|channel, MIDI_EXPRESSION, n % 128);
+            }
+            smf.channel(PPQN/16, MIDI_NOTE_ON|channel, key, 100);
+            smf.channel(PPQN/16, MIDI_NOTE_ON|channel, key, 0);
+        }
+        smf.end_track();
+    }
+
+    return smf.data;
+}
+
+static uint64_t
+play(const char *devname, const char *path, float lookahead)
+{
+    aax::MIDI midi(devname, path);
+    midi.initialize(nullptr);
+    midi.set_lookahead(lookahead);
+    midi.start();
+
+    // stop once every event is played, even when the voices never end
+    uint64_t time_parts = 0;
+    uint32_t wait_parts = 1000;
+    while (midi.process(time_parts, wait_parts) && time_parts < MAX_PARTS) {
+        time_parts += wait_parts;
+    }
+    midi.stop();
+
+    aaxMIDIStats stats;
+    midi.get_stats(stats);
+
+    uint64_t rv = 0;
+    for (int i=0; i<AAX_MIDI_EVENT_MAX; ++i) {
+        rv += stats.events[i];
+    }
+    return rv;
+}
+
+int main(int argc, char **argv)
+{
+    static const float windows[] = { 1.0f, 0.1f, 0.01f, 0.001f, 0.0001f };
+
+    char *devname = getCommandLineOption(argc, argv, "-d");
+    if (!devname) devname = getCommandLineOption(argc, argv, "--device");
+    if (!devname) devname = (char*)DEFAULT_DEVICE;
+
+    std::filesystem::path path = std::filesystem::temp_directory_path();
+    path.append("testlookahead++.mid");
+
+    std::vector<uint8_t> data = song();
+    FILE *fp = fopen(path.string().c_str(), "wb");
+    if (!fp || fwrite(data.data(), 1, data.size(), fp) != data.size())
+    {
+        printf("Unable to write the MIDI file: %s\n", path.string().c_str());
+        if (fp) fclose(fp);
+        return -1;
+    }
+    fclose(fp);
+
+    // a deadlocked sequencer never returns, so fail from another thread
+    std::atomic<bool> done{false};
+    std::thread watchdog([&]() {
+        auto end = std::chrono::steady_clock::now() + std::chrono::seconds(TIMEOUT_SEC);
+        while (!done && std::chrono::steady_clock::now() < end) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        if (!done)
+        {
+            printf("FAIL: the song did not finish within %i seconds\n", TIMEOUT_SEC);
+            fflush(stdout);
+            std::_Exit(-1);
+        }
+    });
+
+    int rv = 0;
+    try
+    {
+        uint64_t expected = play(devname, path.string().c_str(), 0.0f);
+        for (float window : windows)
+        {
+            uint64_t dispatched = play(devname, path.string().c_str(), window);
+            printf("look-ahead: %7.4f sec, events: %lu of %lu: %s\n", window,
+                   (unsigned long)dispatched, (unsigned long)expected,
+                   (dispatched == expected) ? "OK" : "FAIL");
+            if (dispatched != expected) rv = -1;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        printf("FAIL: %s\n", e.what());
+        rv = -1;
+    }
+
+    done = true;
+    watchdog.join();
+    std::filesystem::remove(path);
+
+    return rv;
+}
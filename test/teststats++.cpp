@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2024 by Erik Hofman.
+ * Copyright (C) 2024 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provimed that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provimed with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+#include <aax/midi.h>
+
+#include "driver.h"
+#include "smf_writer.hpp"
+
+#define DEFAULT_DEVICE		"None"
+#define PPQN			96
+#define KEYS			3
+#define MAX_PARTS		(64*PPQN)
+
+/*
+ * Plays a chord of which the first key gets struck twice and which never
+ * gets released, optionally followed by an all-notes-off. The keys which
+ * are down have to return to zero after the all-notes-off.
+ */
+
+static std::vector<uint8_t>
+song(bool all_notes_off)
+{
+    static const uint8_t chord[KEYS] = { 60, 64, 67 };
+
+    smf_writer smf(true);
+    smf.header(0, 1, PPQN);
+
+    smf.begin_track();
+    smf.channel(0, MIDI_PROGRAM_CHANGE, 0);
+    for (int n=0; n<KEYS; ++n) {
+        smf.channel(0, MIDI_NOTE_ON, chord[n], 100);
+    }
+    smf.channel(PPQN, MIDI_NOTE_ON, chord[0], 100);
+    if (all_notes_off) {
+        smf.channel(PPQN, MIDI_CONTROL_CHANGE, MIDI_ALL_NOTES_OFF, 0);
+    }
+    smf.channel(PPQN, MIDI_NOTE_ON, chord[0], 0);
+    smf.end_track();
+
+    return smf.data;
+}
+
+static int
+test(const char *devname, const std::filesystem::path& path, bool all_notes_off)
+{
+    std::vector<uint8_t> data = song(all_notes_off);
+    FILE *fp = fopen(path.string().c_str(), "wb");
+    if (!fp || fwrite(data.data(), 1, data.size(), fp) != data.size())
+    {
+        printf("Unable to write the MIDI file: %s\n", path.string().c_str());
+        if (fp) fclose(fp);
+        return -1;
+    }
+    fclose(fp);
+
+    aax::MIDI midi(devname, path.string().c_str());
+    midi.initialize(nullptr);
+    midi.start();
+
+    uint64_t time_parts = 0;
+    uint32_t wait_parts = 1000;
+    while (midi.process(time_parts, wait_parts) && time_parts < MAX_PARTS) {
+        time_parts += wait_parts;
+    }
+    midi.stop();
+
+    aaxMIDIStats stats;
+    midi.get_stats(stats);
+
+    // the last note-off releases the retriggered key unless all notes
+    // were switched off before
+    uint32_t keys = all_notes_off ? 0 : KEYS-1;
+
+    int rv = 0;
+    const auto& v = stats.voices[0];
+    printf("all-notes-off: %-3s keys: %u (%u), active: %u, peak: %u, "
+           "retriggered: %u\n", all_notes_off ? "yes" : "no",
+           v.keys, keys, v.active, v.peak, v.retriggered);
+    if (v.keys != keys || v.retriggered != 1 || v.active > v.peak) {
+        rv = -1;
+    }
+    for (int i=1; i<MIDI_STATS_MAX_CHANNELS; ++i) {
+        if (stats.voices[i].keys || stats.voices[i].retriggered) rv = -1;
+    }
+    printf("%s\n", rv ? "FAIL" : "OK");
+
+    return rv;
+}
+
+int main(int argc, char **argv)
+{
+    char *devname = getCommandLineOption(argc, argv, "-d");
+    if (!devname) devname = getCommandLineOption(argc, argv, "--device");
+    if (!devname) devname = (char*)DEFAULT_DEVICE;
+
+    std::filesystem::path path = std::filesystem::temp_directory_path();
+    path.append("teststats++.mid");
+
+    int rv = 0;
+    try
+    {
+        if (test(devname, path, false)) rv = -1;
+        if (test(devname, path, true)) rv = -1;
+    }
+    catch (const std::exception& e)
+    {
+        printf("FAIL: %s\n", e.what());
+        rv = -1;
+    }
+    std::filesystem::remove(path);
+
+    return rv;
+}
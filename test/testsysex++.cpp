@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2024 by Erik Hofman.
+ * Copyright (C) 2024 by Adalin B.V.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provimed that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *        this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provimed with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ADALIN B.V. ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ADALIN B.V. OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUTOF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Adalin B.V.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+
+#include <midi/sysex.hpp>
+
+using namespace aeonwave;
+
+#define PAGE			0x40
+
+/*
+ * Checks which bytes of the sysex parameter memory get marked dirty by a
+ * write and are handed out by the next flush.
+ */
+
+struct address_t
+{
+    uint8_t high, mid, low;
+    bool operator==(const address_t& a) const {
+        return high == a.high && mid == a.mid && low == a.low;
+    }
+};
+using addresses_t = std::vector<address_t>;
+
+static addresses_t
+flush(MIDISysexImage& image)
+{
+    addresses_t rv;
+    image.flush([&](uint8_t high, uint8_t mid, uint8_t low) {
+        rv.push_back({high, mid, low});
+    });
+    return rv;
+}
+
+static int
+check(const char *name, bool ok)
+{
+    printf("%-48s %s\n", name, ok ? "OK" : "FAIL");
+    return ok ? 0 : -1;
+}
+
+int main()
+{
+    MIDISysexImage image({ PAGE });
+    int rv = 0;
+
+    // a write which carries from the low into the middle address byte
+    static const uint8_t bulk[] = { 1, 2, 3, 4 };
+    size_t n = image.write(PAGE, 0x11, 0x7e, bulk, sizeof(bulk), true);
+    addresses_t expected = {
+        { PAGE, 0x11, 0x7e }, { PAGE, 0x11, 0x7f },
+        { PAGE, 0x12, 0x00 }, { PAGE, 0x12, 0x01 }
+    };
+    rv |= check("bulk write marks every byte", n == 4 && flush(image) == expected);
+    rv |= check("flush clears the dirty flags", flush(image).empty());
+    rv |= check("bulk write is readable", image.get(PAGE, 0x12, 0x01)[0] == 4);
+
+    // a parameter change updates the image without marking it
+    static const uint8_t param[] = { 0x85 };
+    n = image.write(PAGE, 0x11, 0x7e, param, sizeof(param), false);
+    rv |= check("parameter change is not marked", n == 1 && flush(image).empty());
+    rv |= check("values are seven bit", image.get(PAGE, 0x11, 0x7e)[0] == 0x05);
+
+    // a bulk dump applies the bytes which did not change as well
+    n = image.write(PAGE, 0x11, 0x7e, param, sizeof(param), true);
+    expected = { { PAGE, 0x11, 0x7e } };
+    rv |= check("unchanged bytes are marked", n == 0 && flush(image) == expected);
+
+    // a two byte parameter of which the bytes arrive in separate writes
+    static const uint8_t msb[] = { 0x12 };
+    static const uint8_t lsb[] = { 0x34 };
+    image.write(PAGE, 0x15, 0x20, msb, sizeof(msb), true);
+    expected = { { PAGE, 0x15, 0x20 } };
+    rv |= check("first byte of a two byte parameter", flush(image) == expected);
+
+    image.write(PAGE, 0x15, 0x21, lsb, sizeof(lsb), true);
+    expected = { { PAGE, 0x15, 0x21 } };
+    const uint8_t *value = image.get(PAGE, 0x15, 0x20);
+    rv |= check("second byte after a flush", flush(image) == expected &&
+                value[0] == 0x12 && value[1] == 0x34);
+
+    // writes never cross into the next page
+    n = image.write(PAGE, 0x7f, 0x7f, bulk, sizeof(bulk), true);
+    expected = { { PAGE, 0x7f, 0x7f } };
+    rv |= check("writes stop at the end of a page", n == 1 && flush(image) == expected);
+
+    // pages which are not stored
+    n = image.write(PAGE+1, 0x00, 0x00, bulk, sizeof(bulk), true);
+    rv |= check("other pages are ignored", n == 0 && !image.contains(PAGE+1) &&
+                !image.get(PAGE+1, 0x00, 0x00) && flush(image).empty());
+
+    image.write(PAGE, 0x00, 0x00, bulk, sizeof(bulk), true);
+    image.clear();
+    rv |= check("clear drops the dirty flags", flush(image).empty() &&
+                image.get(PAGE, 0x00, 0x00)[0] == 0);
+
+    return rv;
+}